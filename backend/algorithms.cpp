@@ -2,222 +2,387 @@
 #include <cmath>
 #include <algorithm>
 #include <limits>
+#include <climits>
 #include <set>
 #include <iostream>
+#include <thread>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define DDA_X86 1
+#endif
 
-// DDA
-std::vector<Point> dda(int x1, int y1, int x2, int y2) {
-    std::vector<Point> pixels;
-    int dx = x2 - x1;
-    int dy = y2 - y1;
-    
-    // Calcula o número de passos seguindo a lógica da imagem
-    int passos;
-    if (std::abs(dx) > std::abs(dy)) {
-        passos = std::abs(dx);
-    } else {
-        passos = std::abs(dy);
+static_assert(sizeof(Point) == 2 * sizeof(int), "Point precisa ser dois int contíguos");
+
+// Nos kernels SIMD cada pista guarda q e r em int32: 2n + incremento do
+// resto precisa caber, então linhas maiores ficam no escalar
+static const long long MAX_PASSOS_SIMD = 1LL << 28;
+
+// DDA escalar a partir do pixel k0 (cauda dos kernels SIMD)
+static Point* ddaDesde(int x1, int y1, long long dx, long long dy, long long passos, long long k0, Point* out) {
+    EixoDda x(x1, dx, passos, k0, 1), y(y1, dy, passos, k0, 1);
+    for (long long k = k0; k <= passos; k++) {
+        *out++ = Point{(int)x.q, (int)y.q};
+        x.avancar();
+        y.avancar();
     }
-    
-    if (passos == 0) { 
-        pixels.push_back({x1, y1}); 
-        return pixels; 
+    return out;
+}
+
+#ifdef DDA_X86
+// 8 pixels por iteração: a pista i começa no pixel i e anda 8 por vez. Os
+// pares (x, y) são intercalados e gravados como 2 vetores de 256 bits.
+__attribute__((target("avx2")))
+static Point* ddaAvx2(int x1, int y1, int x2, int y2, Point* out) {
+    const long long dx = (long long)x2 - x1, dy = (long long)y2 - y1;
+    const long long passos = std::max(std::llabs(dx), std::llabs(dy));
+    const long long blocos = (passos + 1) / 8;
+    if (passos == 0 || passos >= MAX_PASSOS_SIMD) return dda<Point*>(x1, y1, x2, y2, out);
+
+    alignas(32) int qx[8], rx[8], qy[8], ry[8];
+    for (int i = 0; i < 8; i++) {
+        EixoDda ex(x1, dx, passos, i, 8), ey(y1, dy, passos, i, 8);
+        qx[i] = (int)ex.q; rx[i] = (int)ex.r;
+        qy[i] = (int)ey.q; ry[i] = (int)ey.r;
     }
-    
-    float x_incr = dx / (float)passos;
-    float y_incr = dy / (float)passos;
-    
-    float x = x1, y = y1;
-    
-    pixels.push_back({(int)std::round(x), (int)std::round(y)}); // pixel inicial
-    for (int k = 1; k <= passos; k++) {
-        x = x + x_incr;
-        y = y + y_incr;
-        pixels.push_back({(int)std::round(x), (int)std::round(y)});
+    const EixoDda px(x1, dx, passos, 0, 8), py(y1, dy, passos, 0, 8);
+    __m256i vqx = _mm256_load_si256((const __m256i*)qx), vrx = _mm256_load_si256((const __m256i*)rx);
+    __m256i vqy = _mm256_load_si256((const __m256i*)qy), vry = _mm256_load_si256((const __m256i*)ry);
+    const __m256i pqx = _mm256_set1_epi32((int)px.passoQ), prx = _mm256_set1_epi32((int)px.passoR);
+    const __m256i pqy = _mm256_set1_epi32((int)py.passoQ), pry = _mm256_set1_epi32((int)py.passoR);
+    const __m256i den = _mm256_set1_epi32((int)px.den), limite = _mm256_set1_epi32((int)px.den - 1);
+
+    for (long long b = 0; b < blocos; b++) {
+        __m256i lo = _mm256_unpacklo_epi32(vqx, vqy), hi = _mm256_unpackhi_epi32(vqx, vqy);
+        _mm256_storeu_si256((__m256i*)out, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(out + 4), _mm256_permute2x128_si256(lo, hi, 0x31));
+        out += 8;
+
+        // r >= den vira máscara -1: tira den do resto e soma 1 ao quociente
+        vqx = _mm256_add_epi32(vqx, pqx);
+        vrx = _mm256_add_epi32(vrx, prx);
+        __m256i mx = _mm256_cmpgt_epi32(vrx, limite);
+        vrx = _mm256_sub_epi32(vrx, _mm256_and_si256(mx, den));
+        vqx = _mm256_sub_epi32(vqx, mx);
+
+        vqy = _mm256_add_epi32(vqy, pqy);
+        vry = _mm256_add_epi32(vry, pry);
+        __m256i my = _mm256_cmpgt_epi32(vry, limite);
+        vry = _mm256_sub_epi32(vry, _mm256_and_si256(my, den));
+        vqy = _mm256_sub_epi32(vqy, my);
     }
-    
+    return ddaDesde(x1, y1, dx, dy, passos, blocos * 8, out);
+}
+
+// Mesmo esquema com 4 pistas de 128 bits
+__attribute__((target("sse2")))
+static Point* ddaSse2(int x1, int y1, int x2, int y2, Point* out) {
+    const long long dx = (long long)x2 - x1, dy = (long long)y2 - y1;
+    const long long passos = std::max(std::llabs(dx), std::llabs(dy));
+    const long long blocos = (passos + 1) / 4;
+    if (passos == 0 || passos >= MAX_PASSOS_SIMD) return dda<Point*>(x1, y1, x2, y2, out);
+
+    alignas(16) int qx[4], rx[4], qy[4], ry[4];
+    for (int i = 0; i < 4; i++) {
+        EixoDda ex(x1, dx, passos, i, 4), ey(y1, dy, passos, i, 4);
+        qx[i] = (int)ex.q; rx[i] = (int)ex.r;
+        qy[i] = (int)ey.q; ry[i] = (int)ey.r;
+    }
+    const EixoDda px(x1, dx, passos, 0, 4), py(y1, dy, passos, 0, 4);
+    __m128i vqx = _mm_load_si128((const __m128i*)qx), vrx = _mm_load_si128((const __m128i*)rx);
+    __m128i vqy = _mm_load_si128((const __m128i*)qy), vry = _mm_load_si128((const __m128i*)ry);
+    const __m128i pqx = _mm_set1_epi32((int)px.passoQ), prx = _mm_set1_epi32((int)px.passoR);
+    const __m128i pqy = _mm_set1_epi32((int)py.passoQ), pry = _mm_set1_epi32((int)py.passoR);
+    const __m128i den = _mm_set1_epi32((int)px.den), limite = _mm_set1_epi32((int)px.den - 1);
+
+    for (long long b = 0; b < blocos; b++) {
+        _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi32(vqx, vqy));
+        _mm_storeu_si128((__m128i*)(out + 2), _mm_unpackhi_epi32(vqx, vqy));
+        out += 4;
+
+        vqx = _mm_add_epi32(vqx, pqx);
+        vrx = _mm_add_epi32(vrx, prx);
+        __m128i mx = _mm_cmpgt_epi32(vrx, limite);
+        vrx = _mm_sub_epi32(vrx, _mm_and_si128(mx, den));
+        vqx = _mm_sub_epi32(vqx, mx);
+
+        vqy = _mm_add_epi32(vqy, pqy);
+        vry = _mm_add_epi32(vry, pry);
+        __m128i my = _mm_cmpgt_epi32(vry, limite);
+        vry = _mm_sub_epi32(vry, _mm_and_si128(my, den));
+        vqy = _mm_sub_epi32(vqy, my);
+    }
+    return ddaDesde(x1, y1, dx, dy, passos, blocos * 4, out);
+}
+#endif
+
+SimdLevel ddaSimdLevel() {
+#ifdef DDA_X86
+    static const SimdLevel nivel = __builtin_cpu_supports("avx2") ? SimdLevel::Avx2
+                                 : __builtin_cpu_supports("sse2") ? SimdLevel::Sse2
+                                                                  : SimdLevel::Escalar;
+    return nivel;
+#else
+    return SimdLevel::Escalar;
+#endif
+}
+
+Point* ddaKernel(SimdLevel nivel, int x1, int y1, int x2, int y2, Point* out) {
+    if (nivel > ddaSimdLevel()) nivel = ddaSimdLevel();
+#ifdef DDA_X86
+    if (nivel == SimdLevel::Avx2) return ddaAvx2(x1, y1, x2, y2, out);
+    if (nivel == SimdLevel::Sse2) return ddaSse2(x1, y1, x2, y2, out);
+#endif
+    return dda<Point*>(x1, y1, x2, y2, out);
+}
+
+Point* dda(int x1, int y1, int x2, int y2, Point* out) {
+    return ddaKernel(ddaSimdLevel(), x1, y1, x2, y2, out);
+}
+
+// DDA
+std::vector<Point> dda(int x1, int y1, int x2, int y2) {
+    std::vector<Point> pixels(lineLength(x1, y1, x2, y2));
+    dda(x1, y1, x2, y2, pixels.data());
     return pixels;
 }
 
 // Bresenham (linha)
 std::vector<Point> bresenhamLine(int x1, int y1, int x2, int y2) {
-    std::vector<Point> pixels;
-    int dx, dy, x, y, i;
-    int const1, const2, p;
-    int incrx, incry;
-    
-    dx = x2 - x1;
-    dy = y2 - y1;
-    
-    if (dx >= 0) {
-        incrx = 1;
-    } else {
-        incrx = -1;
-        dx = -dx;
-    }
-    
-    if (dy >= 0) {
-        incry = 1;
-    } else {
-        incry = -1;
-        dy = -dy;
-    }
-    
-    x = x1;
-    y = y1;
-    pixels.push_back({x, y}); 
-    
-    if (dy < dx) {
-        p = 2 * dy - dx;
-        const1 = 2 * dy;
-        const2 = 2 * (dy - dx);
-        
-        for (i = 0; i < dx; i++) {
-            x += incrx;
-            if (p < 0) {
-                p += const1;
-            } else {
-                y += incry;
-                p += const2;
-            }
-            pixels.push_back({x, y});
-        }
-    } else {
-        // Caso onde dy é dominante
-        p = 2 * dx - dy;
-        const1 = 2 * dx;
-        const2 = 2 * (dx - dy);
-        
-        for (i = 0; i < dy; i++) {
-            y += incry;
-            if (p < 0) {
-                p += const1;
-            } else {
-                x += incrx;
-                p += const2;
-            }
-            pixels.push_back({x, y}); // colora_pixel
-        }
-    }
-    
+    std::vector<Point> pixels(lineLength(x1, y1, x2, y2));
+    bresenhamLine(x1, y1, x2, y2, pixels.data());
     return pixels;
 }
 
+void bresenhamLineParallel(int x1, int y1, int x2, int y2, Point* out, unsigned partes) {
+    const long long n = (long long)lineLength(x1, y1, x2, y2);
+    if (partes < 1) partes = 1;
+    if ((long long)partes > n) partes = (unsigned)n;
+
+    // a thread atual fica com o último trecho
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i + 1 < partes; i++) {
+        long long k0 = n * i / partes, k1 = n * (i + 1) / partes;
+        threads.emplace_back([=] { bresenhamLineRange(x1, y1, x2, y2, k0, k1, out + k0); });
+    }
+    long long k0 = n * (partes - 1) / partes;
+    bresenhamLineRange(x1, y1, x2, y2, k0, n, out + k0);
+    for (auto& t : threads) t.join();
+}
+
+unsigned partesParaLinha(size_t n) {
+    if (n < LIMIAR_LINHA_PARALELA) return 1;
+    unsigned nucleos = std::max(1u, std::thread::hardware_concurrency());
+    size_t porTamanho = n / (LIMIAR_LINHA_PARALELA / 4);
+    return (unsigned)std::min<size_t>(nucleos, porTamanho);
+}
+
 // Bresenham (círculo)
+// Saída em ordem de perímetro: começa em (xc, yc + r) e segue no sentido
+// horário (para +x, depois descendo). O vetor já nasce com o tamanho exato
+// e é preenchido pela versão com iterador.
 std::vector<Point> bresenhamCircle(int xc, int yc, int r) {
-    std::vector<Point> pixels;
-    int x, y, p;
-    
-    // Procedimento plot_circle_points - plota os 8 pontos simétricos
-    auto plot_circle_points = [&]() {
-        pixels.push_back({xc + x, yc + y});
-        pixels.push_back({xc - x, yc + y});
-        pixels.push_back({xc + x, yc - y});
-        pixels.push_back({xc - x, yc - y});
-        pixels.push_back({xc + y, yc + x});
-        pixels.push_back({xc - y, yc + x});
-        pixels.push_back({xc + y, yc - x});
-        pixels.push_back({xc - y, yc - x});
-    };
-    
-    // Inicialização
-    x = 0;
-    y = r;
-    p = 3 - 2 * r;
-    plot_circle_points();
-    
-    // Loop principal - enquanto x < y
-    while (x < y) {
-        if (p < 0) {
-            // Caso p < 0
-            p = p + 4 * x + 6;
-        } else {
-            // Caso p >= 0
-            p = p + 4 * (x - y) + 10;
-            y = y - 1;
-        }
-        x = x + 1;
-        plot_circle_points();
-    }
-    
-    // remover duplicatas ocasionais
-    std::sort(pixels.begin(), pixels.end());
-    pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+    std::vector<Point> pixels(circleLength(r));
+    bresenhamCircle(xc, yc, r, pixels.data());
     return pixels;
 }
 
-// Rasterize JSON -> pixels (ser usado em /draw e transformações)
-json rasterize(const json& dados, const std::string& tipo) {
-    std::vector<Point> pts;
-    if (tipo == "linha") {
-        std::string algoritmo = dados.value("algoritmo", std::string("bresenham"));
-        int x1 = dados["x1"].get<int>();
-        int y1 = dados["y1"].get<int>();
-        int x2 = dados["x2"].get<int>();
-        int y2 = dados["y2"].get<int>();
-        if (algoritmo == "dda")
-            pts = dda(x1, y1, x2, y2);
-        else
-            pts = bresenhamLine(x1, y1, x2, y2);
-    } else if (tipo == "circulo") {
-        int xc = dados["xc"].get<int>();
-        int yc = dados["yc"].get<int>();
-        int r = dados["r"].get<int>();
-        pts = bresenhamCircle(xc, yc, r);
+// Rasterize spec -> pontos (base para /draw, transformações e recorte)
+std::vector<Point> rasterizePoints(const ShapeSpec& s) {
+    if (s.tipo == ShapeType::Linha) {
+        const LineSpec& l = s.linha;
+        if (l.largura > 1) {
+            std::vector<Point> pixels;
+            thickLinePixels(l, std::back_inserter(pixels));
+            return pixels;
+        }
+        if (l.algoritmo == LineAlgorithm::Dda)
+            return dda(l.x1, l.y1, l.x2, l.y2);
+        if (l.algoritmo == LineAlgorithm::RunSlice) {
+            std::vector<Point> pixels(lineLength(l.x1, l.y1, l.x2, l.y2));
+            runSliceLine(l.x1, l.y1, l.x2, l.y2, pixels.data());
+            return pixels;
+        }
+        if (l.algoritmo == LineAlgorithm::Wu) {
+            std::vector<Point> pixels(2 * lineLength(l.x1, l.y1, l.x2, l.y2));
+            pixels.resize(rasterizeTo(s, pixels.data()) - pixels.data());
+            return pixels;
+        }
+        size_t n = lineLength(l.x1, l.y1, l.x2, l.y2);
+        unsigned partes = partesParaLinha(n);
+        if (partes <= 1) return bresenhamLine(l.x1, l.y1, l.x2, l.y2);
+        std::vector<Point> pixels(n);
+        bresenhamLineParallel(l.x1, l.y1, l.x2, l.y2, pixels.data(), partes);
+        return pixels;
+    }
+    if (s.tipo == ShapeType::Disco) {
+        // 1ª passada só soma as larguras: alocação única, tamanho exato
+        const CircleSpec& c = s.circulo;
+        size_t n = 0;
+        diskRows(c.xc, c.yc, c.r, [&n](int, int x0, int x1) { n += (size_t)((long long)x1 - x0 + 1); });
+        std::vector<Point> pixels(n);
+        diskPixels(c.xc, c.yc, c.r, pixels.data());
+        return pixels;
+    }
+    if (s.tipo == ShapeType::Elipse) {
+        const EllipseSpec& e = s.elipse;
+        size_t n = 0;
+        auto somar = [&n](int, int x0, int x1) { n += (size_t)((long long)x1 - x0 + 1); };
+        if (e.preenchida) filledEllipseRows(e.xc, e.yc, e.rx, e.ry, somar);
+        else ellipseRows(e.xc, e.yc, e.rx, e.ry, somar);
+        std::vector<Point> pixels(n);
+        rasterizeTo(s, pixels.data());
+        return pixels;
     }
+    return bresenhamCircle(s.circulo.xc, s.circulo.yc, s.circulo.r);
+}
 
-    json pixels = json::array();
-    for (const auto& p : pts)
-        pixels.push_back({{"x", p.first}, {"y", p.second}});
-    return pixels;
+// ---- Linha grossa ----
+
+static long long paraLL(double v) {
+    return (long long)std::max(-1e15, std::min(1e15, v));
+}
+
+// Pixels x (inteiros) com lo <= a*x + c < hi. A divisão dá os extremos a
+// menos de um pixel; o ajuste final usa o próprio teste, então o resultado
+// é exato para a expressão a*x + c (monótona em x).
+static bool faixa(double a, double c, double lo, double hi, long long& x0, long long& x1) {
+    auto dentro = [&](long long x) {
+        double v = a * (double)x + c;
+        return lo <= v && v < hi;
+    };
+    if (a == 0.0) {
+        if (!dentro(0)) return false;
+        x0 = paraLL(-1e300);
+        x1 = paraLL(1e300);
+        return true;
+    }
+    double p = (lo - c) / a, q = (hi - c) / a;
+    x0 = paraLL(std::floor(std::min(p, q)));
+    x1 = paraLL(std::ceil(std::max(p, q)));
+    while (dentro(x0 - 1)) x0--;
+    while (x0 <= x1 && !dentro(x0)) x0++;
+    while (dentro(x1 + 1)) x1++;
+    while (x1 >= x0 && !dentro(x1)) x1--;
+    return x0 <= x1;
 }
 
+// Pixels x com centro estritamente dentro do disco de diâmetro `diametro`
+// centrado em (cx, cy), na linha y; teste em inteiros: 4*dist^2 < diametro^2
+static bool faixaDisco(long long cx, long long cy, long long diametro, long long y,
+                       long long& x0, long long& x1) {
+    const long long dy = y - cy, limite = diametro * diametro;
+    auto dentro = [&](long long x) { return 4 * ((x - cx) * (x - cx) + dy * dy) < limite; };
+    if (4 * dy * dy >= limite) return false;
+    double meia = std::sqrt(limite / 4.0 - (double)(dy * dy));
+    x0 = paraLL(std::floor(cx - meia));
+    x1 = paraLL(std::ceil(cx + meia));
+    while (x0 <= x1 && !dentro(x0)) x0++;
+    while (x1 >= x0 && !dentro(x1)) x1--;
+    return x0 <= x1;
+}
 
-// Limites da janela (globais para o algoritmo)
-static double xmin_global, xmax_global, ymin_global, ymax_global;
+long long margemLinha(const LineSpec& l) {
+    if (l.largura <= 1) return 0;
+    double meia = l.largura / 2.0;
+    // os cantos da ponta quadrada ficam a meia * sqrt(2) do extremo
+    return (long long)std::ceil(l.ponta == LineCap::Quadrada ? meia * std::sqrt(2.0) : meia);
+}
 
-// Função region_code conforme mostrado na imagem
-int region_code(double x, double y) {
-    int codigo = 0;
-    
-    if (x < xmin_global) {
-        codigo = codigo + 1;
+// Tudo é calculado relativo a (x1, y1): o resultado depende só de
+// (dx, dy), largura e ponta, como no cache de stencils
+ThickLine::ThickLine(const LineSpec& l)
+    : ox_(l.x1), oy_(l.y1), dx_((long long)l.x2 - l.x1), dy_((long long)l.y2 - l.y1),
+      largura_(l.largura), meia_(l.largura / 2.0), redonda_(l.ponta == LineCap::Redonda) {
+    comprimento_ = std::sqrt((double)dx_ * dx_ + (double)dy_ * dy_);
+    if (comprimento_ > 0) {
+        ux_ = dx_ / comprimento_;
+        uy_ = dy_ / comprimento_;
+    } else {
+        ux_ = 1.0;
+        uy_ = 0.0;
     }
-    
-    if (x > xmax_global) {
-        codigo = codigo + 2;
+    bool quadrada = l.ponta == LineCap::Quadrada || (l.ponta == LineCap::Reta && comprimento_ == 0);
+    extensao_ = quadrada ? meia_ : 0.0;
+
+    long long alcance = (long long)std::ceil(meia_ + extensao_);
+    yInicio_ = std::max<long long>(INT_MIN, std::min<long long>(l.y1, l.y2) - alcance);
+    yFim_ = std::min<long long>(INT_MAX, std::max<long long>(l.y1, l.y2) + alcance);
+}
+
+bool ThickLine::span(int y, Span& s) const {
+    long long x0 = LLONG_MAX, x1 = LLONG_MIN;
+    long long a0, a1, b0, b1;
+    const long long ry = (long long)y - oy_;
+
+    // corpo: t = r.u em [-extensao, comprimento + extensao) e d = r.n em
+    // [-meia, meia), com r = p - (x1, y1) e n = (-uy, ux)
+    if (faixa(ux_, ry * uy_, -extensao_, comprimento_ + extensao_, a0, a1) &&
+        faixa(-uy_, ry * ux_, -meia_, meia_, b0, b1)) {
+        x0 = std::max(a0, b0);
+        x1 = std::min(a1, b1);
+        if (x0 > x1) { x0 = LLONG_MAX; x1 = LLONG_MIN; }
     }
-    
-    if (y < ymin_global) {
-        codigo = codigo + 4;
+
+    // pontas redondas: a forma é convexa, então a união na linha é um intervalo
+    if (redonda_) {
+        if (faixaDisco(0, 0, largura_, ry, a0, a1)) { x0 = std::min(x0, a0); x1 = std::max(x1, a1); }
+        if (faixaDisco(dx_, dy_, largura_, ry, a0, a1)) { x0 = std::min(x0, a0); x1 = std::max(x1, a1); }
     }
-    
-    if (y > ymax_global) {
-        codigo = codigo + 8;
+
+    if (x0 > x1) return false;
+    x0 += ox_;
+    x1 += ox_;
+    s = Span{y, (int)std::max<long long>(INT_MIN, x0), (int)std::min<long long>(INT_MAX, x1)};
+    return true;
+}
+
+std::vector<Span> rasterizeSpans(const ShapeSpec& s) {
+    std::vector<Span> spans;
+    rasterizeSpansTo(s, std::back_inserter(spans));
+    return spans;
+}
+
+Raster rasterizeAs(const ShapeSpec& s, bool emSpans) {
+    Raster r;
+    r.emSpans = emSpans;
+    if (!emSpans && temCobertura(s)) {
+        const LineSpec& l = s.linha;
+        // no máximo dois pixels por passo; escreve direto e corta o que sobrou
+        const size_t n = 2 * lineLength(l.x1, l.y1, l.x2, l.y2);
+        r.pixels.resize(n);
+        r.alfas.resize(n);
+        Point* p = r.pixels.data();
+        uint8_t* a = r.alfas.data();
+        wuLinePixels(l.x1, l.y1, l.x2, l.y2, [&p, &a](int x, int y, int alfa) {
+            *p++ = {x, y};
+            *a++ = (uint8_t)alfa;
+        });
+        r.pixels.resize(p - r.pixels.data());
+        r.alfas.resize(a - r.alfas.data());
+        return r;
     }
-    
-    return codigo;
+    if (emSpans) r.spans = rasterizeSpans(s);
+    else r.pixels = rasterizePoints(s);
+    return r;
 }
 
+
 bool cohen_sutherland_clip(double x1, double y1, double x2, double y2,
                            double rx, double ry, double rw, double rh,
                            double &ox1, double &oy1, double &ox2, double &oy2)
 {
-    // Definir limites da janela globalmente
-    xmin_global = rx;
-    xmax_global = rx + rw;
-    ymin_global = ry;
-    ymax_global = ry + rh;
+    // Limites da janela ficam na pilha de cada chamada (seguro entre threads)
+    const ClipRect janela = {rx, ry, rx + rw, ry + rh};
     
     bool aceite = false;
     bool feito = false;
     int c1, c2, cfora;
-    double xint, yint;
+    double xint = 0.0, yint = 0.0;
     
     while (!feito) {
-        c1 = region_code(x1, y1);
-        c2 = region_code(x2, y2);
+        c1 = region_code(janela, x1, y1);
+        c2 = region_code(janela, x2, y2);
         
         if ((c1 == 0) && (c2 == 0)) {
             aceite = true;
@@ -233,17 +398,17 @@ bool cohen_sutherland_clip(double x1, double y1, double x2, double y2,
             
             // Calcula interseção com os limites da janela
             if ((cfora & 1) == 1) {
-                xint = xmin_global;
-                yint = y1 + (y2 - y1) * (xmin_global - x1) / (x2 - x1);
+                xint = janela.xmin;
+                yint = y1 + (y2 - y1) * (janela.xmin - x1) / (x2 - x1);
             } else if ((cfora & 2) == 2) {
-                xint = xmax_global;
-                yint = y1 + (y2 - y1) * (xmax_global - x1) / (x2 - x1);
+                xint = janela.xmax;
+                yint = y1 + (y2 - y1) * (janela.xmax - x1) / (x2 - x1);
             } else if ((cfora & 4) == 4) {
-                yint = ymin_global;
-                xint = x1 + (x2 - x1) * (ymin_global - y1) / (y2 - y1);
+                yint = janela.ymin;
+                xint = x1 + (x2 - x1) * (janela.ymin - y1) / (y2 - y1);
             } else if ((cfora & 8) == 8) {
-                yint = ymax_global;
-                xint = x1 + (x2 - x1) * (ymax_global - y1) / (y2 - y1);
+                yint = janela.ymax;
+                xint = x1 + (x2 - x1) * (janela.ymax - y1) / (y2 - y1);
             }
             
             if (c1 == cfora) {
@@ -340,62 +505,161 @@ bool clip_line(int alg,
 }
 
 
-json recortarObjeto(const json &req) {
-    json resp;
+// Linha com os extremos recortados arredondados para pixels
+static LineSpec linhaRecortada(double ox1, double oy1, double ox2, double oy2, LineAlgorithm algoritmo) {
+    LineSpec l;
+    l.x1 = (int)std::round(ox1);
+    l.y1 = (int)std::round(oy1);
+    l.x2 = (int)std::round(ox2);
+    l.y2 = (int)std::round(oy2);
+    l.algoritmo = algoritmo;
+    return l;
+}
 
-    try {
-        std::string tipo = req.value("tipo", std::string("linha"));
-        if (tipo != "linha") {
-            resp["aceita"] = false;
-            resp["error"] = "Recorte suporta apenas linhas.";
-            return resp;
-        }
+ClipResult recortar(const ClipSpec &c, bool emSpans) {
+    ClipResult resultado;
 
-        // Obter retângulo de recorte
-        double xmin = req.value("xmin", 0.0);
-        double ymin = req.value("ymin", 0.0);
-        double xmax = req.value("xmax", 0.0);
-        double ymax = req.value("ymax", 0.0);
-
-        // Obter dados da linha
-        auto dados = req["dados"];
-        double x1 = dados["x1"].get<double>();
-        double y1 = dados["y1"].get<double>();
-        double x2 = dados["x2"].get<double>();
-        double y2 = dados["y2"].get<double>();
-
-        // Aplicar algoritmo de recorte de linha
-        std::string algoritmo = req.value("algoritmo", std::string("CoSutherland"));
-        int alg = (algoritmo == "LiBarsky") ? 1 : 0;
-        
-        double ox1, oy1, ox2, oy2;
-        double rw = xmax - xmin;
-        double rh = ymax - ymin;
-        
-        bool aceita = clip_line(alg, x1, y1, x2, y2, xmin, ymin, rw, rh, ox1, oy1, ox2, oy2);
-        
-        if (aceita) {
-            // Criar nova linha recortada
-            json novosDados = dados;
-            novosDados["x1"] = (int)std::round(ox1);
-            novosDados["y1"] = (int)std::round(oy1);
-            novosDados["x2"] = (int)std::round(ox2);
-            novosDados["y2"] = (int)std::round(oy2);
-            
-            // Rasterizar a nova linha
-            auto pixels = rasterize(novosDados, tipo);
-            
-            resp["aceita"] = true;
-            resp["pixels"] = pixels;
-        } else {
-            resp["aceita"] = false;
-            resp["pixels"] = json::array();
+    // Aplicar algoritmo de recorte de linha
+    double ox1, oy1, ox2, oy2;
+    double rw = c.xmax - c.xmin;
+    double rh = c.ymax - c.ymin;
+    
+    resultado.aceita = clip_line(c.algoritmo, c.x1, c.y1, c.x2, c.y2, c.xmin, c.ymin, rw, rh, ox1, oy1, ox2, oy2);
+    
+    if (resultado.aceita) {
+        // Rasterizar a nova linha recortada
+        ShapeSpec recortada;
+        recortada.tipo = ShapeType::Linha;
+        recortada.linha = linhaRecortada(ox1, oy1, ox2, oy2, c.algoritmoLinha);
+        resultado.linha = recortada.linha;
+        resultado.raster = rasterizeAs(recortada, emSpans);
+    }
+    
+    return resultado;
+}
+
+ClipClass classificar(const ShapeSpec &s, const ClipRect &janela) {
+    if (s.tipo == ShapeType::Linha && s.linha.largura > 1) {
+        const LineSpec &l = s.linha;
+        double m = (double)margemLinha(l);
+        double xmin = std::min(l.x1, l.x2) - m, xmax = std::max(l.x1, l.x2) + m;
+        double ymin = std::min(l.y1, l.y2) - m, ymax = std::max(l.y1, l.y2) + m;
+        if (xmax < janela.xmin || xmin > janela.xmax || ymax < janela.ymin || ymin > janela.ymax)
+            return ClipClass::Fora;
+        if (xmin >= janela.xmin && xmax <= janela.xmax && ymin >= janela.ymin && ymax <= janela.ymax)
+            return ClipClass::Dentro;
+        return ClipClass::Cruza;
+    }
+    if (s.tipo == ShapeType::Linha) {
+        int c1 = region_code(janela, s.linha.x1, s.linha.y1);
+        int c2 = region_code(janela, s.linha.x2, s.linha.y2);
+        if ((c1 | c2) == 0) return ClipClass::Dentro;
+        if (c1 & c2) return ClipClass::Fora;
+        return ClipClass::Cruza;
+    }
+
+    double xc, yc, rx, ry;
+    if (s.tipo == ShapeType::Elipse) {
+        xc = s.elipse.xc; yc = s.elipse.yc;
+        rx = std::fabs((double)s.elipse.rx); ry = std::fabs((double)s.elipse.ry);
+    } else {
+        xc = s.circulo.xc; yc = s.circulo.yc;
+        rx = ry = std::fabs((double)s.circulo.r);
+    }
+    if (xc + rx < janela.xmin || xc - rx > janela.xmax ||
+        yc + ry < janela.ymin || yc - ry > janela.ymax)
+        return ClipClass::Fora;
+    if (xc - rx >= janela.xmin && xc + rx <= janela.xmax &&
+        yc - ry >= janela.ymin && yc + ry <= janela.ymax)
+        return ClipClass::Dentro;
+    return ClipClass::Cruza;
+}
+
+// Corta o span pela janela (limites inclusivos); false se não sobra nada
+static bool cortarSpan(Span &s, const ClipRect &janela) {
+    const double xa = std::ceil(janela.xmin), xb = std::floor(janela.xmax);
+    if (s.y < janela.ymin || s.y > janela.ymax) return false;
+    if (s.x1 < xa || s.x0 > xb) return false;
+    s.x0 = (int)std::max<double>(s.x0, xa);
+    s.x1 = (int)std::min<double>(s.x1, xb);
+    return true;
+}
+
+static Raster rasterDeSpans(std::vector<Span> spans, bool emSpans) {
+    Raster r;
+    r.emSpans = emSpans;
+    if (emSpans) {
+        r.spans = std::move(spans);
+    } else {
+        for (const Span &sp : spans)
+            for (long long x = sp.x0; x <= sp.x1; x++) r.pixels.push_back({(int)x, sp.y});
+    }
+    return r;
+}
+
+// Spans da linha grossa, do disco ou da elipse preenchida cortados pela
+// janela: o preenchimento não vira uma forma recortada, então o recorte é
+// feito no raster. A linha grossa só percorre as scanlines da janela.
+static Raster recortarPreenchido(const ShapeSpec &f, const ClipRect &janela, bool emSpans) {
+    std::vector<Span> spans;
+    Span s;
+    if (f.tipo == ShapeType::Disco) {
+        diskRows(f.circulo.xc, f.circulo.yc, f.circulo.r, [&](int y, int x0, int x1) {
+            s = Span{y, x0, x1};
+            if (cortarSpan(s, janela)) spans.push_back(s);
+        });
+        return rasterDeSpans(std::move(spans), emSpans);
+    }
+    if (f.tipo == ShapeType::Elipse) {
+        const EllipseSpec &e = f.elipse;
+        filledEllipseRows(e.xc, e.yc, e.rx, e.ry, [&](int y, int x0, int x1) {
+            s = Span{y, x0, x1};
+            if (cortarSpan(s, janela)) spans.push_back(s);
+        });
+        return rasterDeSpans(std::move(spans), emSpans);
+    }
+    ThickLine t(f.linha);
+    for (long long y = std::max<long long>(t.yInicio(), paraLL(std::ceil(janela.ymin)));
+         y <= std::min<long long>(t.yFim(), paraLL(std::floor(janela.ymax))); y++) {
+        if (t.span((int)y, s) && cortarSpan(s, janela)) spans.push_back(s);
+    }
+    return rasterDeSpans(std::move(spans), emSpans);
+}
+
+SceneClipResult recortarCena(const std::vector<ShapeSpec> &formas, const ClipRect &janela,
+                             int algoritmo, bool emSpans) {
+    SceneClipResult resultado;
+    const double rw = janela.xmax - janela.xmin;
+    const double rh = janela.ymax - janela.ymin;
+
+    for (size_t i = 0; i < formas.size(); i++) {
+        const ShapeSpec &s = formas[i];
+        ClipClass classe = classificar(s, janela);
+        if (classe == ClipClass::Fora) continue;
+
+        ShapeSpec aceita = s;
+        if (classe == ClipClass::Cruza && preenchido(s)) {
+            Raster r = recortarPreenchido(s, janela, emSpans);
+            if (r.tamanho() == 0) continue;
+            resultado.indices.push_back(i);
+            resultado.formas.push_back(s);
+            resultado.rasters.push_back(std::move(r));
+            continue;
         }
-        
-        return resp;
-    } catch (const std::exception &ex) {
-        resp["aceita"] = false;
-        resp["error"] = std::string("recortarObjeto error: ") + ex.what();
-        return resp;
+        if (classe == ClipClass::Cruza) {
+            if (s.tipo != ShapeType::Linha) {
+                resultado.naoSuportados.push_back(i);
+                continue;
+            }
+            double ox1, oy1, ox2, oy2;
+            if (!clip_line(algoritmo, s.linha.x1, s.linha.y1, s.linha.x2, s.linha.y2,
+                           janela.xmin, janela.ymin, rw, rh, ox1, oy1, ox2, oy2))
+                continue;
+            aceita.linha = linhaRecortada(ox1, oy1, ox2, oy2, s.linha.algoritmo);
+        }
+        resultado.indices.push_back(i);
+        resultado.formas.push_back(aceita);
+        resultado.rasters.push_back(rasterizeAs(aceita, emSpans));
     }
+    return resultado;
 }
@@ -1,18 +1,507 @@
 #ifndef ALGORITHMS_H
 #define ALGORITHMS_H
 
+#include <cstdint>
 #include <vector>
 #include <utility>
 #include <string>
-#include "libs/json.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include "specs.h"
 
-using json = nlohmann::json;
 using Point = std::pair<int,int>;
 
+// Número exato de pixels de uma linha: max(|dx|, |dy|) + 1
+inline size_t lineLength(int x1, int y1, int x2, int y2) {
+    int dx = std::abs(x2 - x1);
+    int dy = std::abs(y2 - y1);
+    return (size_t)(dx > dy ? dx : dy) + 1;
+}
+
+// Versões com iterador de saída: escrevem cada pixel em `*out++` e retornam
+// o iterador final. Servem para rasterizar num buffer reaproveitado, num
+// framebuffer ou direto em spans. Exatamente lineLength() pixels são escritos.
+
+// Divisão inteira arredondando para -infinito (den > 0)
+inline long long divPiso(long long num, long long den) {
+    long long q = num / den;
+    return (num % den < 0) ? q - 1 : q;
+}
+
+// Uma coordenada do DDA em ponto fixo exato. O pixel k da linha fica em
+// inicio + floor(k*d/n + 1/2) (arredondamento da razão exata, empate para
+// cima), mantido como quociente q e resto r do numerador 2*k*d + n sobre o
+// denominador 2n. Avançar `passo` pixels soma um incremento fixo e corrige
+// o resto com uma comparação, sem float e sem deriva em linhas longas.
+struct EixoDda {
+    long long q, r, passoQ, passoR, den;
+
+    EixoDda(int inicio, long long d, long long n, long long k0, long long passo) {
+        den = 2 * n;
+        long long num = 2 * k0 * d + n;
+        q = inicio + divPiso(num, den);
+        r = num - divPiso(num, den) * den;
+        passoQ = divPiso(2 * passo * d, den);
+        passoR = 2 * passo * d - passoQ * den;
+    }
+    void avancar() {
+        q += passoQ;
+        r += passoR;
+        if (r >= den) {
+            r -= den;
+            q++;
+        }
+    }
+};
+
+// DDA: passos = max(|dx|, |dy|) e incremento dx/passos, dy/passos por
+// pixel, com as coordenadas em ponto fixo exato (EixoDda) em vez de float
+template <class Out>
+Out dda(int x1, int y1, int x2, int y2, Out out) {
+    const long long dx = (long long)x2 - x1, dy = (long long)y2 - y1;
+    const long long passos = std::max(std::llabs(dx), std::llabs(dy));
+
+    if (passos == 0) {
+        *out++ = Point{x1, y1};
+        return out;
+    }
+
+    EixoDda x(x1, dx, passos, 0, 1), y(y1, dy, passos, 0, 1);
+    for (long long k = 0; k <= passos; k++) {
+        *out++ = Point{(int)x.q, (int)y.q};
+        x.avancar();
+        y.avancar();
+    }
+    return out;
+}
+
+// Mesmo resultado num buffer contíguo, com SIMD quando a CPU tem (AVX2 ou
+// SSE2, escolhido em tempo de execução). Tem prioridade sobre o template
+// para Point*.
+Point* dda(int x1, int y1, int x2, int y2, Point* out);
+
+// Kernels do DDA em buffer. ddaSimdLevel() é o melhor nível que a CPU
+// suporta (o usado por dda() em Point*); níveis acima dele caem para ele.
+enum class SimdLevel { Escalar, Sse2, Avx2 };
+SimdLevel ddaSimdLevel();
+Point* ddaKernel(SimdLevel nivel, int x1, int y1, int x2, int y2, Point* out);
+
+// Bresenham (linha)
+template <class Out>
+Out bresenhamLine(int x1, int y1, int x2, int y2, Out out) {
+    int dx, dy, x, y, i;
+    int const1, const2, p;
+    int incrx, incry;
+    
+    dx = x2 - x1;
+    dy = y2 - y1;
+    
+    if (dx >= 0) {
+        incrx = 1;
+    } else {
+        incrx = -1;
+        dx = -dx;
+    }
+    
+    if (dy >= 0) {
+        incry = 1;
+    } else {
+        incry = -1;
+        dy = -dy;
+    }
+    
+    x = x1;
+    y = y1;
+    *out++ = Point{x, y}; 
+    
+    if (dy < dx) {
+        p = 2 * dy - dx;
+        const1 = 2 * dy;
+        const2 = 2 * (dy - dx);
+        
+        for (i = 0; i < dx; i++) {
+            x += incrx;
+            if (p < 0) {
+                p += const1;
+            } else {
+                y += incry;
+                p += const2;
+            }
+            *out++ = Point{x, y};
+        }
+    } else {
+        // Caso onde dy é dominante
+        p = 2 * dx - dy;
+        const1 = 2 * dx;
+        const2 = 2 * (dx - dy);
+        
+        for (i = 0; i < dy; i++) {
+            y += incry;
+            if (p < 0) {
+                p += const1;
+            } else {
+                x += incrx;
+                p += const2;
+            }
+            *out++ = Point{x, y}; // colora_pixel
+        }
+    }
+    
+    return out;
+}
+
+// Run-slice: percorre a linha de Bresenham por corridas (trechos com o eixo
+// menor constante) em vez de pixel a pixel. O passo j do eixo menor cobre
+// os passos k em [inicio, fim) do eixo maior, com fim = ceil(maior*(2j+1) /
+// (2*menor)) (mesmo arredondamento do Bresenham, empate para cima); o erro
+// de `fim` é mantido em inteiros, então há um único desvio por corrida.
+// Chama corrida(j, inicio, fim) para cada corrida, em ordem; `xMaior` diz
+// qual eixo é o maior (o mesmo critério de bresenhamLine).
+template <class Corrida>
+void runSliceRuns(int x1, int y1, int x2, int y2, bool& xMaior, Corrida corrida) {
+    long long dx = std::llabs((long long)x2 - x1), dy = std::llabs((long long)y2 - y1);
+    xMaior = dy < dx;
+    long long maior = xMaior ? dx : dy, menor = xMaior ? dy : dx;
+    const long long n = maior + 1;
+
+    if (menor == 0) {
+        corrida(0LL, 0LL, n);
+        return;
+    }
+
+    // fim = ceil(num / (2*menor)) com num = maior*(2j+1); resto = fim*2*menor - num
+    const long long dois = 2 * menor;
+    const long long passo = (2 * maior) / dois, sobra = (2 * maior) % dois;
+    long long inicio = 0;
+    long long fim = (maior + dois - 1) / dois;
+    long long resto = fim * dois - maior;
+    for (long long j = 0; inicio < n; j++) {
+        long long f = fim < n ? fim : n;
+        corrida(j, inicio, f);
+        inicio = f;
+        fim += passo;
+        resto -= sobra;
+        if (resto < 0) {
+            resto += dois;
+            fim++;
+        }
+    }
+}
+
+// Pixels da linha por run-slice: os mesmos (e na mesma ordem) de
+// bresenhamLine(), escritos corrida a corrida
+template <class Out>
+Out runSliceLine(int x1, int y1, int x2, int y2, Out out) {
+    const int sx = x2 >= x1 ? 1 : -1, sy = y2 >= y1 ? 1 : -1;
+    bool xMaior;
+    runSliceRuns(x1, y1, x2, y2, xMaior, [&](long long j, long long inicio, long long fim) {
+        // cópia local: o iterador capturado por referência não fica em registrador
+        Out o = out;
+        if (xMaior) {
+            const int y = y1 + sy * (int)j;
+            int x = x1 + sx * (int)inicio;
+            for (long long k = inicio; k < fim; k++, x += sx) *o++ = Point{x, y};
+        } else {
+            const int x = x1 + sx * (int)j;
+            int y = y1 + sy * (int)inicio;
+            for (long long k = inicio; k < fim; k++, y += sy) *o++ = Point{x, y};
+        }
+        out = o;
+    });
+    return out;
+}
+
+// Pixel com cobertura de 8 bits (0 = transparente, 255 = cheio)
+struct PixelAlfa {
+    int x, y;
+    uint8_t a;
+};
+
+// Linha suavizada de Xiaolin Wu em inteiros exatos. No passo k do eixo
+// maior a linha ideal está em k*menor/maior no eixo menor: parte inteira
+// e resto andam como no Bresenham, e a cobertura a = floor(256*resto/maior)
+// anda por um incremento fixo com o próprio resto, sem divisão nem float
+// por pixel. O pixel da parte inteira recebe 255 - a e o vizinho recebe a
+// (omitido quando a = 0), então cada passo soma 255 e linhas horizontais,
+// verticais e a 45° saem iguais às serrilhadas. `fn(x, y, a)` em ordem de k.
+template <class Fn>
+void wuLinePixels(int x1, int y1, int x2, int y2, Fn fn) {
+    const long long dx = std::llabs((long long)x2 - x1), dy = std::llabs((long long)y2 - y1);
+    const bool xMaior = dy < dx;
+    const long long maior = xMaior ? dx : dy, menor = xMaior ? dy : dx;
+    const int sMaior = (xMaior ? x2 >= x1 : y2 >= y1) ? 1 : -1;
+    const int sMenor = (xMaior ? y2 >= y1 : x2 >= x1) ? 1 : -1;
+    int M = xMaior ? x1 : y1, m = xMaior ? y1 : x1;
+    if (maior == 0) {
+        fn(x1, y1, 255);
+        return;
+    }
+
+    // 256*resto = a*maior + s, com 0 <= s < maior
+    const long long passoA = 256 * menor / maior, sobraA = 256 * menor % maior;
+    long long resto = 0, a = 0, s = 0;
+    for (long long k = 0; k <= maior; k++) {
+        if (xMaior) {
+            fn(M, m, (int)(255 - a));
+            if (a) fn(M, m + sMenor, (int)a);
+        } else {
+            fn(m, M, (int)(255 - a));
+            if (a) fn(m + sMenor, M, (int)a);
+        }
+        M += sMaior;
+        resto += menor;
+        a += passoA;
+        s += sobraA;
+        if (s >= maior) {
+            s -= maior;
+            a++;
+        }
+        if (resto >= maior) {
+            resto -= maior;
+            a -= 256;
+            m += sMenor;
+        }
+    }
+}
+
+template <class Out>
+Out wuLine(int x1, int y1, int x2, int y2, Out out) {
+    Out o = out;
+    wuLinePixels(x1, y1, x2, y2, [&o](int x, int y, int a) { *o++ = PixelAlfa{x, y, (uint8_t)a}; });
+    return o;
+}
+
+// Só a linha fina com "wu" tem cobertura; as demais formas são cheias
+inline bool temCobertura(const ShapeSpec& s) {
+    return s.tipo == ShapeType::Linha && s.linha.largura <= 1 && s.linha.algoritmo == LineAlgorithm::Wu;
+}
+
+// Disco, elipse preenchida e linha grossa são áreas geradas direto como
+// spans (O(linhas))
+inline bool preenchido(const ShapeSpec& s) {
+    return s.tipo == ShapeType::Disco || (s.tipo == ShapeType::Elipse && s.elipse.preenchida) ||
+           (s.tipo == ShapeType::Linha && s.linha.largura > 1);
+}
+
+// Estado do laço do octante no círculo de Bresenham
+struct CircleStep {
+    int x, y, p;
+};
+
+// Buffers de rascunho de cada thread, reaproveitados entre chamadas para não
+// alocar a cada rasterização (no servidor, um por worker). Cada campo tem
+// um único usuário, que o esvazia ao começar e não guarda referências.
+struct ScratchArena {
+    std::vector<CircleStep> marcosCirculo;
+    std::vector<CircleStep> blocoCirculo;
+    std::string stream;   // buffer do RasterStream
+};
+
+inline ScratchArena& scratchArena() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+// Bresenham (linha) só dos pixels de índice k0 até k1 - 1 (o pixel k é o
+// ponto depois de k passos no eixo maior). O estado no início do trecho sai
+// em O(1): depois de k passos o eixo menor andou round(k * menor / maior),
+// com empate para cima, e a variável de decisão fecha a conta. Com k0 = 0 e
+// k1 = lineLength() escreve o mesmo que bresenhamLine().
+template <class Out>
+Out bresenhamLineRange(int x1, int y1, int x2, int y2, long long k0, long long k1, Out out) {
+    int dx = x2 - x1;
+    int dy = y2 - y1;
+    int incrx = dx >= 0 ? 1 : -1;
+    int incry = dy >= 0 ? 1 : -1;
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    if (k0 >= k1) return out;
+
+    const bool xMaior = dy < dx;
+    const long long maior = xMaior ? dx : dy;
+    const long long menor = xMaior ? dy : dx;
+    const long long j = maior == 0 ? 0 : (2 * k0 * menor + maior) / (2 * maior);
+    int p = (int)(2 * menor - maior + 2 * k0 * menor - 2 * maior * j);
+    const int const1 = (int)(2 * menor);
+    const int const2 = (int)(2 * (menor - maior));
+
+    int x = x1 + (int)((xMaior ? k0 : j) * incrx);
+    int y = y1 + (int)((xMaior ? j : k0) * incry);
+    *out++ = Point{x, y};
+    for (long long k = k0 + 1; k < k1; k++) {
+        if (xMaior) {
+            x += incrx;
+            if (p < 0) {
+                p += const1;
+            } else {
+                y += incry;
+                p += const2;
+            }
+        } else {
+            y += incry;
+            if (p < 0) {
+                p += const1;
+            } else {
+                x += incrx;
+                p += const2;
+            }
+        }
+        *out++ = Point{x, y};
+    }
+    return out;
+}
+
+// Bresenham (círculo) com iterador de saída: mesma ordem de perímetro da
+// versão com vetor, em memória O(sqrt(r)). O perímetro é o octante
+// percorrido 8 vezes, alternando ida e volta; nas voltas o octante é
+// regenerado em blocos a partir de estados salvos na passada de contagem.
+// Os estados ficam no ScratchArena da thread (não é reentrante).
+template <class Out>
+Out bresenhamCircle(int xc, int yc, int r, Out out) {
+    if (r == 0) {
+        *out++ = Point{xc, yc};
+        return out;
+    }
+    if (r < 0) {
+        int a = -r;
+        *out++ = Point{xc, yc + a};
+        *out++ = Point{xc + a, yc};
+        *out++ = Point{xc, yc - a};
+        *out++ = Point{xc - a, yc};
+        return out;
+    }
+
+    using Estado = CircleStep;
+    auto passo = [](Estado& e) {
+        if (e.p < 0) {
+            e.p = e.p + 4 * e.x + 6;
+        } else {
+            e.p = e.p + 4 * (e.x - e.y) + 10;
+            e.y = e.y - 1;
+        }
+        e.x = e.x + 1;
+    };
+
+    // 1ª passada: conta os n passos do octante, guardando um estado a cada `bloco`
+    const int raiz = (int)std::sqrt((double)r);
+    const int bloco = raiz > 1024 ? raiz : 1024;
+    ScratchArena& arena = scratchArena();
+    std::vector<Estado>& marcos = arena.marcosCirculo;
+    marcos.clear();
+    Estado e{0, r, 3 - 2 * r};
+    int n = 0;
+    for (;;) {
+        if (n % bloco == 0) marcos.push_back(e);
+        if (!(e.x < e.y)) break;
+        passo(e);
+        n++;
+    }
+    const int m = (e.x == e.y) ? 2 * n : 2 * n - 1;
+
+    // Octante do índice i0 ao i1 (ida) ou do i1 ao i0 (volta); `fn(x, y)`
+    std::vector<Estado>& buffer = arena.blocoCirculo;
+    auto ida = [&](int i0, int i1, auto fn) {
+        Estado s = marcos[i0 / bloco];
+        for (int i = i0 / bloco * bloco; i < i0; i++) passo(s);
+        for (int i = i0; i <= i1; i++) {
+            fn(s.x, s.y);
+            if (i < i1) passo(s);
+        }
+    };
+    auto volta = [&](int i0, int i1, auto fn) {
+        if (i0 > i1) return;
+        for (int b = i1 / bloco; b >= i0 / bloco; b--) {
+            int inicio = b * bloco;
+            int lo = i0 > inicio ? i0 : inicio;
+            int hi = i1 < inicio + bloco - 1 ? i1 : inicio + bloco - 1;
+            buffer.resize(hi - inicio + 1);
+            Estado s = marcos[b];
+            for (int i = inicio; i <= hi; i++) {
+                buffer[i - inicio] = s;
+                if (i < hi) passo(s);
+            }
+            for (int i = hi; i >= lo; i--) fn(buffer[i - inicio].x, buffer[i - inicio].y);
+        }
+    };
+
+    // Quarto de círculo Q[0..m]: Q[i] = (x_i, y_i) para i <= n e
+    // Q[m - i] = (y_i, x_i); cada quadrante percorre Q num sentido
+    auto quarto = [&](int k0, int k1, bool crescente, int sa, int sb) {
+        auto octante = [&](int a, int b) { *out++ = Point{xc + sa * a, yc + sb * b}; };
+        auto espelho = [&](int a, int b) { *out++ = Point{xc + sa * b, yc + sb * a}; };
+        int fimOctante = k1 < n ? k1 : n;
+        int inicioEspelho = k0 > n + 1 ? k0 : n + 1;
+        if (crescente) {
+            if (k0 <= fimOctante) ida(k0, fimOctante, octante);
+            volta(m - k1, m - inicioEspelho, espelho);
+        } else {
+            if (inicioEspelho <= k1) ida(m - k1, m - inicioEspelho, espelho);
+            volta(k0, fimOctante, octante);
+        }
+    };
+    quarto(0, m, true, 1, 1);
+    quarto(0, m - 1, false, 1, -1);
+    quarto(1, m, true, -1, -1);
+    quarto(1, m - 1, false, -1, 1);
+    return out;
+}
+
+// Número de pixels do círculo: 4 quartos de m pontos, com m contado pelos
+// passos do octante (sem escrever nada)
+inline size_t circleLength(int r) {
+    if (r == 0) return 1;
+    if (r < 0) return 4;
+    CircleStep e{0, r, 3 - 2 * r};
+    int n = 0;
+    while (e.x < e.y) {
+        if (e.p < 0) {
+            e.p = e.p + 4 * e.x + 6;
+        } else {
+            e.p = e.p + 4 * (e.x - e.y) + 10;
+            e.y = e.y - 1;
+        }
+        e.x = e.x + 1;
+        n++;
+    }
+    return 4 * (size_t)((e.x == e.y) ? 2 * n : 2 * n - 1);
+}
+
+// Versões que retornam vetor (alocação única, tamanho exato)
 std::vector<Point> dda(int x1, int y1, int x2, int y2);
 std::vector<Point> bresenhamLine(int x1, int y1, int x2, int y2);
 std::vector<Point> bresenhamCircle(int xc, int yc, int r);
 
+// Bresenham (linha) em paralelo: o eixo maior é dividido em `partes` trechos
+// contíguos, cada um rasterizado por uma thread com bresenhamLineRange() na
+// sua fatia de `out` (lineLength() posições). Pixels idênticos aos da
+// versão sequencial.
+void bresenhamLineParallel(int x1, int y1, int x2, int y2, Point* out, unsigned partes);
+
+// Linhas a partir deste tamanho são divididas entre os núcleos
+const size_t LIMIAR_LINHA_PARALELA = (size_t)1 << 20;
+
+// Número de partes para uma linha de `n` pixels: no máximo um trecho por
+// núcleo e nenhum menor que LIMIAR_LINHA_PARALELA / 4
+unsigned partesParaLinha(size_t n);
+
+// Janela de recorte passada por valor a cada chamada
+struct ClipRect {
+    double xmin, ymin, xmax, ymax;
+};
+
+// Função region_code: bits 1=esquerda, 2=direita, 4=abaixo, 8=acima
+inline int region_code(const ClipRect& janela, double x, double y) {
+    int codigo = 0;
+    if (x < janela.xmin) codigo |= 1;
+    if (x > janela.xmax) codigo |= 2;
+    if (y < janela.ymin) codigo |= 4;
+    if (y > janela.ymax) codigo |= 8;
+    return codigo;
+}
+
 bool cohen_sutherland_clip(double x1, double y1, double x2, double y2,
                                   double rx, double ry, double rw, double rh,
                                   double &ox1, double &oy1, double &ox2, double &oy2);
@@ -26,8 +515,464 @@ bool clip_line(int alg,
               double rx,double ry,double rw,double rh,
               double &ox1,double &oy1,double &ox2,double &oy2);
 
-json rasterize(const json& dados, const std::string& tipo);
+// Span horizontal: pixels de x0 até x1 (inclusivos) na linha y
+struct Span {
+    int y, x0, x1;
+};
+
+// Saída de rasterização: pixels individuais ou spans por scanline.
+// Quando vem do cache de stencils, `stencil` aponta para os deslocamentos
+// (compartilhados entre respostas) e a posição final é stencil + origem;
+// a soma só acontece na serialização. Use base() para ler os elementos.
+struct Raster {
+    bool emSpans = false;
+    std::vector<Point> pixels;
+    std::vector<uint8_t> alfas;   // cobertura de cada pixel (linha wu); vazio = cheios
+    std::vector<Span> spans;
+    std::shared_ptr<const Raster> stencil;
+    Point origem{0, 0};
+
+    const Raster& base() const { return stencil ? *stencil : *this; }
+    size_t tamanho() const {
+        const Raster& b = base();
+        return b.emSpans ? b.spans.size() : b.pixels.size();
+    }
+};
+
+// Iterador de saída que junta pixels consecutivos da mesma linha y em spans
+// (ordem preservada). Permite passar os kernels direto para spans.
+class SpanInserter {
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    explicit SpanInserter(std::vector<Span>& spans) : spans_(&spans) {}
+
+    SpanInserter& operator=(const Point& p) {
+        if (!spans_->empty()) {
+            Span& s = spans_->back();
+            if (s.y == p.second) {
+                if (p.first >= s.x0 && p.first <= s.x1) return *this;
+                if (p.first == s.x1 + 1) { s.x1 = p.first; return *this; }
+                if (p.first == s.x0 - 1) { s.x0 = p.first; return *this; }
+            }
+        }
+        spans_->push_back({p.second, p.first, p.first});
+        return *this;
+    }
+    SpanInserter& operator*() { return *this; }
+    SpanInserter& operator++() { return *this; }
+    SpanInserter& operator++(int) { return *this; }
+
+private:
+    std::vector<Span>* spans_;
+};
+
+// Como SpanInserter, mas entrega cada span a `out` assim que ele fecha (o
+// pixel seguinte não o estende), sem guardar os anteriores. O último span
+// só sai em finalizar().
+template <class Out>
+class SpanWriter {
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    explicit SpanWriter(Out out) : out_(out) {}
+
+    // Começa com um span já aberto (os pixels seguintes podem estendê-lo)
+    void iniciar(const Span& s) { atual_ = s; pendente_ = true; }
+    // Descarta o span aberto sem entregá-lo
+    void descartar() { pendente_ = false; }
+    const Span* aberto() const { return pendente_ ? &atual_ : nullptr; }
+
+    SpanWriter& operator=(const Point& p) {
+        if (pendente_ && atual_.y == p.second) {
+            if (p.first >= atual_.x0 && p.first <= atual_.x1) return *this;
+            if (p.first == atual_.x1 + 1) { atual_.x1 = p.first; return *this; }
+            if (p.first == atual_.x0 - 1) { atual_.x0 = p.first; return *this; }
+        }
+        if (pendente_) *out_++ = atual_;
+        atual_ = Span{p.second, p.first, p.first};
+        pendente_ = true;
+        return *this;
+    }
+    SpanWriter& operator*() { return *this; }
+    SpanWriter& operator++() { return *this; }
+    SpanWriter& operator++(int) { return *this; }
+
+    Out finalizar() {
+        if (pendente_) *out_++ = atual_;
+        pendente_ = false;
+        return out_;
+    }
+
+private:
+    Out out_;
+    Span atual_{0, 0, 0};
+    bool pendente_ = false;
+};
+
+// Spans da linha por run-slice, sem passar por pixels: com x dominante cada
+// corrida já é um span; com y dominante cada pixel é uma linha própria.
+// Mesmo resultado de juntar os pixels de bresenhamLine() com SpanWriter.
+template <class Out>
+Out runSliceSpans(int x1, int y1, int x2, int y2, Out out) {
+    const int sx = x2 >= x1 ? 1 : -1, sy = y2 >= y1 ? 1 : -1;
+    bool xMaior;
+    runSliceRuns(x1, y1, x2, y2, xMaior, [&](long long j, long long inicio, long long fim) {
+        if (xMaior) {
+            const int a = x1 + sx * (int)inicio, b = x1 + sx * (int)(fim - 1);
+            *out++ = Span{y1 + sy * (int)j, a < b ? a : b, a < b ? b : a};
+        } else {
+            const int x = x1 + sx * (int)j;
+            int y = y1 + sy * (int)inicio;
+            for (long long k = inicio; k < fim; k++, y += sy) *out++ = Span{y, x, x};
+        }
+    });
+    return out;
+}
+
+// Linha grossa (largura > 1) preenchida como polígono convexo: o retângulo
+// de largura `largura` em volta do segmento mais as pontas. Cada scanline
+// cruza a forma num único intervalo, então sai um span por y, de baixo
+// para cima e sem sobreposição: o custo é proporcional à área (em pixels)
+// ou à altura (em spans), e não a largura × comprimento pixels repetidos.
+// Entra todo pixel cujo centro está na forma. As bordas são fechadas de um
+// lado e abertas do outro, então uma linha horizontal de largura w cobre
+// exatamente w linhas. Linha de comprimento zero vira um quadrado w × w
+// (ou um disco, com ponta redonda).
+class ThickLine {
+public:
+    explicit ThickLine(const LineSpec& l);
+
+    long long yInicio() const { return yInicio_; }
+    long long yFim() const { return yFim_; }
+    // Span da scanline y; false se ela não cruza a forma
+    bool span(int y, Span& s) const;
+
+private:
+    long long ox_, oy_, dx_, dy_;   // origem (x1, y1) e extremo relativo
+    long long largura_;
+    double ux_, uy_;        // direção unitária de (x1, y1) para (x2, y2)
+    double comprimento_;
+    double meia_;           // largura / 2
+    double extensao_;       // quanto o corpo passa dos extremos (ponta quadrada)
+    bool redonda_;
+    long long yInicio_, yFim_;   // scanlines que podem cruzar a forma
+};
+
+// Quanto a linha grossa passa do segmento em cada eixo (0 na linha fina)
+long long margemLinha(const LineSpec& l);
+
+template <class Out>
+Out thickLineSpans(const LineSpec& l, Out out) {
+    ThickLine t(l);
+    Span s;
+    for (long long y = t.yInicio(); y <= t.yFim(); y++)
+        if (t.span((int)y, s)) *out++ = s;
+    return out;
+}
+
+template <class Out>
+Out thickLinePixels(const LineSpec& l, Out out) {
+    ThickLine t(l);
+    Span s;
+    for (long long y = t.yInicio(); y <= t.yFim(); y++) {
+        if (!t.span((int)y, s)) continue;
+        for (long long x = s.x0; x <= s.x1; x++) *out++ = Point{(int)x, s.y};
+    }
+    return out;
+}
+
+// Disco (círculo preenchido) com as mesmas variáveis de decisão do
+// bresenhamCircle(): cada passo do octante (x, y) fecha as scanlines
+// yc ± x com meia largura y e, quando y vai descer, as scanlines yc ± y
+// com meia largura x. Cada scanline sai uma única vez, do pixel mais à
+// esquerda ao mais à direita do contorno, então não há pixels, sort nem
+// dedup. `fn(y, x0, x1)` recebe as linhas na ordem do percurso (pares
+// simétricos, a partir do centro e do topo), não ordenadas por y.
+// r negativo vale como |r|.
+template <class Fn>
+void diskRows(int xc, int yc, int r, Fn fn) {
+    if (r < 0) r = -r;
+    int x = 0, y = r, p = 3 - 2 * r;
+    for (;;) {
+        fn(yc + x, xc - y, xc + y);
+        if (x != 0) fn(yc - x, xc - y, xc + y);
+        if (!(x < y)) break;
+        if (p < 0) {
+            p = p + 4 * x + 6;
+        } else {
+            p = p + 4 * (x - y) + 10;
+            // a linha y só é própria se nenhum x futuro chega nela
+            if (y > x + 1) {
+                fn(yc + y, xc - x, xc + x);
+                fn(yc - y, xc - x, xc + x);
+            }
+            y = y - 1;
+        }
+        x = x + 1;
+    }
+}
+
+template <class Out>
+Out diskSpans(int xc, int yc, int r, Out out) {
+    Out o = out;
+    diskRows(xc, yc, r, [&o](int y, int x0, int x1) { *o++ = Span{y, x0, x1}; });
+    return o;
+}
+
+template <class Out>
+Out diskPixels(int xc, int yc, int r, Out out) {
+    Out o = out;
+    diskRows(xc, yc, r, [&o](int y, int x0, int x1) {
+        for (int x = x0; x <= x1; x++) *o++ = Point{x, y};
+    });
+    return o;
+}
+
+// Elipse pelo ponto médio, só com inteiros, no quarto x >= 0, y >= 0.
+// Região 1 (x anda a cada passo) vai de (0, ry) até a inclinação passar
+// de 1 (2ry²x >= 2rx²y); região 2 (y desce a cada passo) vai até y = 0.
+// As variáveis de decisão estão multiplicadas por 4 para tirar as frações
+// (rx²/4 e (x + 1/2)²). `fn(x, y)` recebe os pontos em ordem, com x
+// crescendo e y descendo, cada um uma vez. Os termos chegam a ~4·R⁴, então
+// `T` precisa de 64 bits até R = 2^14 e de 128 bits acima disso.
+template <class T, class Fn>
+void ellipseQuarterPoints(T rx, T ry, Fn fn) {
+    const T rx2 = rx * rx, ry2 = ry * ry;
+    T x = 0, y = ry;
+    T dx = 0, dy = 2 * rx2 * y;
+    T d = 4 * ry2 - 4 * rx2 * ry + rx2;
+    while (dx < dy) {
+        fn(x, y);
+        x++;
+        dx += 2 * ry2;
+        if (d < 0) {
+            d += 4 * (dx + ry2);
+        } else {
+            y--;
+            dy -= 2 * rx2;
+            d += 4 * (dx - dy + ry2);
+        }
+    }
+    d = ry2 * (2 * x + 1) * (2 * x + 1) + 4 * rx2 * (y - 1) * (y - 1) - 4 * rx2 * ry2;
+    for (;;) {
+        fn(x, y);
+        if (y == 0) break;
+        y--;
+        dy -= 2 * rx2;
+        if (d > 0) {
+            d += 4 * (rx2 - dy);
+        } else {
+            x++;
+            dx += 2 * ry2;
+            d += 4 * (dx - dy + rx2);
+        }
+    }
+    // elipses muito achatadas chegam em y = 0 antes de x = rx
+    while (x < rx) fn(++x, T(0));
+}
+
+const int LIMITE_ELIPSE_64 = 1 << 14;
+
+// Quarto da elipse em corridas horizontais `fn(y, x0, x1)` (x0 <= x1, y
+// descendo de ry a 0). Semi-eixos negativos valem pelo módulo.
+template <class Fn>
+void ellipseQuarterRuns(int rx, int ry, Fn fn) {
+    long long a = rx < 0 ? -(long long)rx : rx, b = ry < 0 ? -(long long)ry : ry;
+    int yRun = 0, x0 = 0, x1 = 0;
+    bool aberta = false;
+    auto ponto = [&](auto x, auto y) {
+        if (aberta && (int)y == yRun) {
+            x1 = (int)x;
+            return;
+        }
+        if (aberta) fn(yRun, x0, x1);
+        yRun = (int)y;
+        x0 = x1 = (int)x;
+        aberta = true;
+    };
+    if (a <= LIMITE_ELIPSE_64 && b <= LIMITE_ELIPSE_64) ellipseQuarterPoints<long long>(a, b, ponto);
+    else ellipseQuarterPoints<__int128>(a, b, ponto);
+    fn(yRun, x0, x1);
+}
+
+// Contorno da elipse: cada corrida do quarto vai para os 4 quadrantes
+// (2 nas corridas que tocam um eixo), sem pontos repetidos, sort ou dedup.
+// A ordem é a das corridas: do topo/fundo (yc ± ry) até a linha do centro.
+template <class Fn>
+void ellipseRows(int xc, int yc, int rx, int ry, Fn fn) {
+    ellipseQuarterRuns(rx, ry, [&](int y, int x0, int x1) {
+        for (int lado = 0; lado < (y == 0 ? 1 : 2); lado++) {
+            const int linha = lado == 0 ? yc + y : yc - y;
+            if (x0 == 0) {
+                fn(linha, xc - x1, xc + x1);
+            } else {
+                fn(linha, xc - x1, xc - x0);
+                fn(linha, xc + x0, xc + x1);
+            }
+        }
+    });
+}
+
+template <class Out>
+Out ellipseSpans(int xc, int yc, int rx, int ry, Out out) {
+    Out o = out;
+    ellipseRows(xc, yc, rx, ry, [&o](int y, int x0, int x1) { *o++ = Span{y, x0, x1}; });
+    return o;
+}
+
+template <class Out>
+Out ellipsePixels(int xc, int yc, int rx, int ry, Out out) {
+    Out o = out;
+    ellipseRows(xc, yc, rx, ry, [&o](int y, int x0, int x1) {
+        for (int x = x0; x <= x1; x++) *o++ = Point{x, y};
+    });
+    return o;
+}
+
+// Elipse preenchida: o quarto tem uma corrida por y, e a scanline ±y vai
+// da ponta externa de um lado à do outro (cobre o contorno da elipse)
+template <class Fn>
+void filledEllipseRows(int xc, int yc, int rx, int ry, Fn fn) {
+    ellipseQuarterRuns(rx, ry, [&](int y, int, int x1) {
+        fn(yc + y, xc - x1, xc + x1);
+        if (y != 0) fn(yc - y, xc - x1, xc + x1);
+    });
+}
+
+template <class Out>
+Out filledEllipseSpans(int xc, int yc, int rx, int ry, Out out) {
+    Out o = out;
+    filledEllipseRows(xc, yc, rx, ry, [&o](int y, int x0, int x1) { *o++ = Span{y, x0, x1}; });
+    return o;
+}
+
+template <class Out>
+Out filledEllipsePixels(int xc, int yc, int rx, int ry, Out out) {
+    Out o = out;
+    filledEllipseRows(xc, yc, rx, ry, [&o](int y, int x0, int x1) {
+        for (int x = x0; x <= x1; x++) *o++ = Point{x, y};
+    });
+    return o;
+}
+
+// Rasteriza o objeto escrevendo cada pixel em `out` (framebuffer, spans...).
+// Linhas vão direto do kernel para `out`, sem vetor intermediário. A linha
+// wu escreve só as posições dos pixels; a cobertura vem de wuLine().
+template <class Out>
+Out rasterizeTo(const ShapeSpec& s, Out out) {
+    if (s.tipo == ShapeType::Linha) {
+        const LineSpec& l = s.linha;
+        if (l.largura > 1)
+            return thickLinePixels(l, out);
+        if (l.algoritmo == LineAlgorithm::Dda)
+            return dda(l.x1, l.y1, l.x2, l.y2, out);
+        if (l.algoritmo == LineAlgorithm::RunSlice)
+            return runSliceLine(l.x1, l.y1, l.x2, l.y2, out);
+        if (l.algoritmo == LineAlgorithm::Wu) {
+            // só as posições; a cobertura sai por wuLine()
+            Out o = out;
+            wuLinePixels(l.x1, l.y1, l.x2, l.y2, [&o](int x, int y, int) { *o++ = Point{x, y}; });
+            return o;
+        }
+        return bresenhamLine(l.x1, l.y1, l.x2, l.y2, out);
+    }
+    if (s.tipo == ShapeType::Disco)
+        return diskPixels(s.circulo.xc, s.circulo.yc, s.circulo.r, out);
+    if (s.tipo == ShapeType::Elipse && s.elipse.preenchida)
+        return filledEllipsePixels(s.elipse.xc, s.elipse.yc, s.elipse.rx, s.elipse.ry, out);
+    if (s.tipo == ShapeType::Elipse)
+        return ellipsePixels(s.elipse.xc, s.elipse.yc, s.elipse.rx, s.elipse.ry, out);
+    return bresenhamCircle(s.circulo.xc, s.circulo.yc, s.circulo.r, out);
+}
+
+// Passos do octante do círculo antes de sair da linha do topo (y = r)
+inline int circleTopRun(int r) {
+    int x = 0, y = r, p = 3 - 2 * r;
+    while (x < y) {
+        if (p < 0) {
+            p = p + 4 * x + 6;
+        } else {
+            p = p + 4 * (x - y) + 10;
+            y = y - 1;
+        }
+        if (y != r) break;
+        x = x + 1;
+    }
+    return x;
+}
+
+// Spans do objeto escritos em `out` um a um, sem vetor intermediário.
+// O perímetro do círculo começa e termina na linha do topo: o primeiro
+// span já sai com as duas metades e a metade final é descartada.
+template <class Out>
+Out rasterizeSpansTo(const ShapeSpec& s, Out out) {
+    if (s.tipo == ShapeType::Linha && s.linha.largura > 1)
+        return thickLineSpans(s.linha, out);
+    if (s.tipo == ShapeType::Linha && s.linha.algoritmo == LineAlgorithm::RunSlice)
+        return runSliceSpans(s.linha.x1, s.linha.y1, s.linha.x2, s.linha.y2, out);
+    if (s.tipo == ShapeType::Disco)
+        return diskSpans(s.circulo.xc, s.circulo.yc, s.circulo.r, out);
+    if (s.tipo == ShapeType::Elipse && s.elipse.preenchida)
+        return filledEllipseSpans(s.elipse.xc, s.elipse.yc, s.elipse.rx, s.elipse.ry, out);
+    if (s.tipo == ShapeType::Elipse)
+        return ellipseSpans(s.elipse.xc, s.elipse.yc, s.elipse.rx, s.elipse.ry, out);
+    SpanWriter<Out> w(out);
+    if (s.tipo == ShapeType::Linha) return rasterizeTo(s, w).finalizar();
+
+    const CircleSpec& c = s.circulo;
+    int t = c.r > 0 ? circleTopRun(c.r) : 0;
+    if (t > 0) w.iniciar(Span{c.yc + c.r, c.xc - t, c.xc + t});
+    w = bresenhamCircle(c.xc, c.yc, c.r, w);
+    const Span* ultimo = w.aberto();
+    if (t > 0 && ultimo && ultimo->y == c.yc + c.r && ultimo->x0 == c.xc - t && ultimo->x1 == c.xc - 1)
+        w.descartar();
+    return w.finalizar();
+}
+
+std::vector<Point> rasterizePoints(const ShapeSpec& s);
+std::vector<Span> rasterizeSpans(const ShapeSpec& s);
+// Em pixels, a linha wu preenche também `alfas`; em spans sai só a área
+// coberta, sem a cobertura
+Raster rasterizeAs(const ShapeSpec& s, bool emSpans);
+
+// Resultado do recorte de um objeto (pixels ainda não serializados)
+struct ClipResult {
+    bool aceita = false;
+    LineSpec linha;   // linha recortada (válida se aceita)
+    Raster raster;
+};
+
+ClipResult recortar(const ClipSpec& c, bool emSpans);
+
+// Posição da caixa envolvente do objeto em relação à janela. Para linhas
+// usa os region codes dos extremos (o mesmo teste trivial do Cohen-Sutherland).
+enum class ClipClass { Dentro, Fora, Cruza };
+ClipClass classificar(const ShapeSpec& s, const ClipRect& janela);
+
+// Saída de recortarCena: só os objetos aceitos ocupam espaço
+struct SceneClipResult {
+    std::vector<size_t> indices;        // posição em `formas` de cada aceito
+    std::vector<ShapeSpec> formas;      // objeto recortado, mesma ordem
+    std::vector<Raster> rasters;        // rasterização, mesma ordem
+    std::vector<size_t> naoSuportados;  // contornos (círculo, elipse) que cruzam a borda
+};
 
-json recortarObjeto(const json& body);
+// Recorte de vários objetos pela mesma janela numa única passada: objetos
+// dentro são aceitos sem recorte, objetos fora são rejeitados, e só as
+// linhas que cruzam a borda passam por clip_line(). Linhas grossas e
+// discos que cruzam a borda mantêm a forma original e têm os spans
+// cortados pela janela. Contornos de círculo e elipse não são recortados:
+// os que cruzam a borda vão para `naoSuportados`.
+SceneClipResult recortarCena(const std::vector<ShapeSpec>& formas, const ClipRect& janela,
+                             int algoritmo, bool emSpans);
 
 #endif
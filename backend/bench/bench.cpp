@@ -0,0 +1,620 @@
+// Benchmarks dos algoritmos de rasterização, recorte e transformação.
+// Binário independente (sem rede). Uso:
+//   make bench
+//   ./bin/bench [filtro] [--tempo ms]
+// `filtro` restringe aos casos cujo nome contém o texto (ex.: "circulo").
+// Só mede; a correção dos kernels é conferida em check.cpp (make check).
+#include "../algorithms.h"
+#include "../encoding.h"
+#include "../scene.h"
+#include "../stencil.h"
+#include "../transformations.h"
+#include "referencias.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+// ---- Contagem de alocações ----
+// Substitui o operator new global para contar alocações por chamada
+// (atômico: a linha paralela aloca nas threads de trabalho). Ficam fora
+// de linha para o compilador não ver malloc/free dentro de new/delete
+// (-Wmismatched-new-delete); os deletes com tamanho repassam para os sem
+// tamanho.
+static std::atomic<long> g_alocacoes{0};
+
+__attribute__((noinline)) void* operator new(std::size_t n) {
+    g_alocacoes.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete[](p); }
+
+// ---- Infraestrutura ----
+
+struct Medida {
+    double ns;          // ns por chamada
+    double alocacoes;   // alocações por chamada
+};
+
+static double g_alvoMs = 200.0;
+static std::string g_filtro;
+
+// Executa `fn` repetidamente por ~g_alvoMs e mede tempo e alocações
+template <class Fn>
+static Medida medir(Fn fn) {
+    fn(); // aquecimento
+    long iteracoes = 0;
+    long alocInicio = g_alocacoes;
+    auto inicio = Clock::now();
+    double decorrido = 0.0;
+    do {
+        fn();
+        iteracoes++;
+        decorrido = std::chrono::duration<double, std::nano>(Clock::now() - inicio).count();
+    } while (decorrido < g_alvoMs * 1e6);
+    return {decorrido / iteracoes, (double)(g_alocacoes - alocInicio) / iteracoes};
+}
+
+static bool selecionado(const std::string& nome) {
+    return g_filtro.empty() || nome.find(g_filtro) != std::string::npos;
+}
+
+static void cabecalho(const char* grupo, const char* param, const char* unidade) {
+    std::printf("\n%-30s %10s %12s %12s %10s\n", grupo, param, "ns/chamada", unidade, "aloc/cham");
+}
+
+// `n` = pixels (ou itens) produzidos por chamada, para a coluna ns/unidade
+static void linha(const std::string& nome, long param, const Medida& m, double n) {
+    std::printf("%-30s %10ld %12.0f %12.2f %10.2f\n", nome.c_str(), param, m.ns, m.ns / n, m.alocacoes);
+}
+
+// Evita que o compilador descarte resultados não usados
+static volatile size_t g_sumidouro = 0;
+
+// ---- Casos ----
+
+static void benchLinhas() {
+    if (!selecionado("linha")) return;
+    cabecalho("linha", "comprimento", "ns/pixel");
+    std::vector<Point> buffer;
+    for (int dx : {10, 100, 1000, 10000, 100000, 1000000}) {
+        int dy = dx / 3;
+        const size_t n = lineLength(0, 0, dx, dy);
+        buffer.resize(n);
+        linha("bresenhamLine (vetor)", dx, medir([&] { g_sumidouro = bresenhamLine(0, 0, dx, dy).size(); }), n);
+        linha("bresenhamLine (buffer)", dx, medir([&] { bresenhamLine(0, 0, dx, dy, buffer.data()); }), n);
+        linha("dda (vetor)", dx, medir([&] { g_sumidouro = dda(0, 0, dx, dy).size(); }), n);
+        linha("dda (buffer)", dx, medir([&] { dda(0, 0, dx, dy, buffer.data()); }), n);
+    }
+}
+
+static const SimdLevel NIVEIS[] = {SimdLevel::Escalar, SimdLevel::Sse2, SimdLevel::Avx2};
+static const char* const NOMES_NIVEIS[] = {"escalar", "sse2", "avx2"};
+
+// Kernels do DDA (float anterior, escalar, SSE2, AVX2) e quantos pixels do
+// float saem do arredondamento exato em linhas longas
+static void benchDda() {
+    if (!selecionado("dda")) return;
+    cabecalho("dda (kernels)", "comprimento", "ns/pixel");
+    std::vector<Point> buffer, exato;
+    for (int dx : {1000, 100000, 10000000}) {
+        int dy = dx / 3 + 1;
+        const size_t n = lineLength(0, 0, dx, dy);
+        buffer.resize(n);
+        linha("dda float (anterior)", dx, medir([&] { ddaFloat(0, 0, dx, dy, buffer.data()); }), n);
+        for (int i = 0; i < 3; i++) {
+            if (NIVEIS[i] > ddaSimdLevel()) break;
+            linha(std::string("dda ") + NOMES_NIVEIS[i], dx,
+                  medir([&] { ddaKernel(NIVEIS[i], 0, 0, dx, dy, buffer.data()); }), n);
+        }
+    }
+    for (int dx : {1000000, 20000000}) {
+        int dy = dx / 3 + 1;
+        const size_t n = lineLength(0, 0, dx, dy);
+        buffer.resize(n);
+        exato.resize(n);
+        ddaFloat(0, 0, dx, dy, buffer.data());
+        dda(0, 0, dx, dy, exato.data());
+        size_t erros = 0;
+        for (size_t k = 0; k < n; k++) erros += buffer[k] != exato[k];
+        std::printf("  dda float, dx=%d: %zu de %zu pixels fora do arredondamento exato\n", dx, erros, n);
+    }
+    std::printf("  (nível SIMD da CPU: %s)\n", NOMES_NIVEIS[(int)ddaSimdLevel()]);
+}
+
+// Linha grossa como polígono (spans e pixels) x o pincel ingênuo, que
+// carimba um quadrado largura × largura em cada pixel da linha fina
+static void benchLinhaGrossa() {
+    if (!selecionado("grossa")) return;
+    cabecalho("linha grossa (1000 px)", "largura", "ns/pixel");
+    const int dx = 1000, dy = 377;
+    std::vector<Point> pixels;
+    std::vector<Span> spans;
+    const std::vector<Point> fina = bresenhamLine(0, 0, dx, dy);
+    for (int w : {2, 4, 16, 64}) {
+        ShapeSpec s;
+        s.linha = {0, 0, dx, dy, LineAlgorithm::Bresenham, w, LineCap::Redonda};
+        pixels.clear();
+        rasterizeTo(s, std::back_inserter(pixels));
+        const size_t area = pixels.size();
+        linha("thickLineSpans", w, medir([&] {
+            spans.clear();
+            thickLineSpans(s.linha, std::back_inserter(spans));
+        }), area);
+        linha("thickLinePixels", w, medir([&] {
+            pixels.clear();
+            thickLinePixels(s.linha, std::back_inserter(pixels));
+        }), area);
+        // referência: pixels escritos com sobreposição, sem deduplicar
+        linha("  carimbo por pixel", w, medir([&] {
+            pixels.clear();
+            for (Point p : fina)
+                for (int oy = -w / 2; oy < w - w / 2; oy++)
+                    for (int ox = -w / 2; ox < w - w / 2; ox++)
+                        pixels.push_back({p.first + ox, p.second + oy});
+        }), area);
+        std::printf("  largura %d: %zu pixels na forma, %zu spans, carimbo escreve %zu\n",
+                    w, area, spans.size(), pixels.size());
+    }
+}
+
+// Bresenham x run-slice em várias inclinações (eixo maior de 100k pixels);
+// o parâmetro é dy por 1000 dx
+static void benchRunSlice() {
+    if (!selecionado("linha")) return;
+    cabecalho("linha (inclinacao)", "dy/1000dx", "ns/pixel");
+    const int dx = 100000;
+    std::vector<Point> buffer;
+    std::vector<Span> spans;
+    for (int milesimos : {0, 10, 50, 250, 500, 1000, 4000}) {
+        // acima de 45 graus o eixo maior passa a ser y
+        int ax = dx, ay = (int)((long long)dx * milesimos / 1000);
+        if (milesimos > 1000) ax = (int)((long long)dx * 1000 / milesimos), ay = dx;
+        const size_t n = lineLength(0, 0, ax, ay);
+        buffer.resize(n);
+        spans.reserve(n);
+        linha("bresenhamLine (buffer)", milesimos, medir([&] { bresenhamLine(0, 0, ax, ay, buffer.data()); }), n);
+        linha("runSliceLine (buffer)", milesimos, medir([&] { runSliceLine(0, 0, ax, ay, buffer.data()); }), n);
+        ShapeSpec s;
+        s.linha = {0, 0, ax, ay, LineAlgorithm::Bresenham};
+        linha("bresenham -> spans", milesimos, medir([&] {
+            spans.clear();
+            rasterizeSpansTo(s, std::back_inserter(spans));
+        }), n);
+        linha("runSliceSpans", milesimos, medir([&] {
+            spans.clear();
+            runSliceSpans(0, 0, ax, ay, std::back_inserter(spans));
+        }), n);
+    }
+}
+
+// Alternativa sem suporte do servidor: o cliente pede a linha em 4x de
+// resolução com 4 deslocamentos no eixo menor e conta as amostras por
+// pixel (16 por pixel). Retorna os pixels com cobertura > 0.
+static size_t superamostragem4x(int x1, int y1, int x2, int y2, std::vector<uint8_t>& contagem,
+                                std::vector<Point>& sub, size_t& amostras) {
+    const int xmin = std::min(x1, x2), ymin = std::min(y1, y2);
+    const int largura = std::abs(x2 - x1) + 2, altura = std::abs(y2 - y1) + 2;
+    const bool xMaior = std::abs(y2 - y1) < std::abs(x2 - x1);
+    contagem.assign((size_t)largura * altura, 0);
+    amostras = 0;
+    size_t pixels = 0;
+    for (int o = 0; o < 4; o++) {
+        int ox = xMaior ? 0 : o - 1, oy = xMaior ? o - 1 : 0;
+        int ax = 4 * (x1 - xmin) + ox, ay = 4 * (y1 - ymin) + oy;
+        int bx = 4 * (x2 - xmin) + ox, by = 4 * (y2 - ymin) + oy;
+        sub.resize(lineLength(ax, ay, bx, by));
+        bresenhamLine(ax, ay, bx, by, sub.data());
+        amostras += sub.size();
+        for (const Point& p : sub) {
+            int cx = (p.first + 2) >> 2, cy = (p.second + 2) >> 2;
+            if (cx < 0 || cy < 0 || cx >= largura || cy >= altura) continue;
+            uint8_t& c = contagem[(size_t)cy * largura + cx];
+            pixels += c == 0;
+            c++;
+        }
+    }
+    return pixels;
+}
+
+static void benchWu() {
+    if (!selecionado("wu")) return;
+    cabecalho("linha wu (dy = 3dx/8)", "comprimento", "ns/pixel");
+    std::vector<PixelAlfa> buffer;
+    std::vector<Point> posicoes, sub;
+    std::vector<uint8_t> contagem;
+    for (int dx : {16, 256, 4096, 65536}) {
+        const int dy = dx * 3 / 8;
+        buffer.resize(2 * lineLength(0, 0, dx, dy));
+        const size_t n = wuLine(0, 0, dx, dy, buffer.data()) - buffer.data();
+        linha("wuLine (buffer)", dx, medir([&] { wuLine(0, 0, dx, dy, buffer.data()); }), n);
+        linha("  wu em double (buffer)", dx, medir([&] { wuFloat(0, 0, dx, dy, buffer.data()); }), n);
+        ShapeSpec s = parseShape({{"x1", 0}, {"y1", 0}, {"x2", dx}, {"y2", dy}, {"algoritmo", "wu"}}, "linha");
+        linha("rasterizeAs (pixels + alfas)", dx, medir([&] { g_sumidouro = rasterizeAs(s, false).tamanho(); }), n);
+        size_t amostras = 0, cobertos = 0;
+        if (dx <= 4096) {
+            cobertos = superamostragem4x(0, 0, dx, dy, contagem, sub, amostras);
+            linha("  superamostragem 4x (cliente)", dx, medir([&] {
+                g_sumidouro = superamostragem4x(0, 0, dx, dy, contagem, sub, amostras);
+            }), n);
+        }
+        // carga útil: triplas wu x as 4 linhas em 4x que o cliente pediria
+        posicoes.resize(n);
+        std::vector<uint8_t> alfas(n);
+        for (size_t i = 0; i < n; i++) {
+            posicoes[i] = {buffer[i].x, buffer[i].y};
+            alfas[i] = buffer[i].a;
+        }
+        std::string bin;
+        appendCoverageBinary(bin, posicoes, alfas, PixelFormat::Int16);
+        std::printf("  dx %d: %zu pixels wu, %zu bytes json, %zu bytes int16", dx, n,
+                    coverageToJson(posicoes, alfas).dump().size(), bin.size());
+        if (dx <= 4096)
+            std::printf("; 4x: %zu amostras (%zu bytes int16) para %zu pixels", amostras, amostras * 4, cobertos);
+        std::printf("\n");
+    }
+}
+
+// Linhas longas divididas entre threads: ganho com 2, 4 e 8 partes
+// (limitado pelos núcleos)
+static void benchLinhaParalela() {
+    if (!selecionado("linha")) return;
+    cabecalho("linha paralela", "comprimento", "ns/pixel");
+    for (int dx : {1000000, 10000000}) {
+        int dy = dx / 3 + 7;
+        const size_t n = lineLength(0, 0, dx, dy);
+        std::vector<Point> seq(n), par(n);
+        linha("bresenhamLine (buffer)", dx, medir([&] { bresenhamLine(0, 0, dx, dy, seq.data()); }), n);
+        for (unsigned partes : {2u, 4u, 8u}) {
+            std::string nome = "bresenhamLineParallel (" + std::to_string(partes) + " partes)";
+            linha(nome, dx, medir([&] { bresenhamLineParallel(0, 0, dx, dy, par.data(), partes); }), n);
+        }
+    }
+    std::printf("  (%u núcleos disponíveis)\n", std::thread::hardware_concurrency());
+}
+
+static void benchCirculos() {
+    if (!selecionado("circulo")) return;
+    cabecalho("circulo", "r", "ns/pixel");
+    for (int r : {1, 10, 100, 1000, 10000, 100000}) {
+        const size_t n = bresenhamCircle(0, 0, r).size();
+        linha("bresenhamCircle", r, medir([&] { g_sumidouro = bresenhamCircle(0, 0, r).size(); }), n);
+        // versão em memória limitada (streaming): sem vetor do perímetro
+        linha("bresenhamCircle (iterador)", r, medir([&] {
+            size_t k = 0;
+            bresenhamCircle(0, 0, r, ContadorPixels(k));
+            g_sumidouro = k;
+        }), n);
+        linha("  referencia (sort/unique)", r, medir([&] { g_sumidouro = bresenhamCircleOrdenado(0, 0, r).size(); }), n);
+    }
+}
+
+static void benchDiscos() {
+    if (!selecionado("disco")) return;
+    cabecalho("disco", "r", "ns/pixel");
+    std::vector<Point> pixels;
+    std::vector<Span> spans;
+    for (int r : {4, 16, 64, 256}) {
+        spans.clear();
+        diskSpans(0, 0, r, std::back_inserter(spans));
+        size_t area = 0;
+        for (const Span& sp : spans) area += (size_t)(sp.x1 - sp.x0 + 1);
+        linha("diskSpans", r, medir([&] {
+            spans.clear();
+            diskSpans(0, 0, r, std::back_inserter(spans));
+        }), area);
+        // pixels num buffer do tamanho exato, como em rasterizePoints()
+        pixels.resize(area);
+        linha("diskPixels", r, medir([&] { diskPixels(0, 0, r, pixels.data()); }), area);
+        // referência: contorno, sort por scanline e preenchimento em pixels
+        linha("  contorno + sort + preenchimento", r, medir([&] {
+            Point* p = pixels.data();
+            for (const Span& sp : discoPorContorno(0, 0, r))
+                for (int x = sp.x0; x <= sp.x1; x++) *p++ = {x, sp.y};
+        }), area);
+        std::printf("  r %d: %zu pixels, %zu spans (%zu vs %zu bytes como int32)\n",
+                    r, area, spans.size(), spans.size() * 3 * 4, area * 2 * 4);
+    }
+}
+
+// Referências por amostragem: ângulos da forma paramétrica arredondados
+// (com sort/unique), e o teste implícito em cada pixel da caixa (o
+// contorno passa pelo pixel se f muda de sinal entre os cantos)
+static std::vector<Point> elipseParametrica(int rx, int ry) {
+    const int n = 8 * (rx + ry) + 8;
+    std::vector<Point> pixels(n);
+    for (int k = 0; k < n; k++) {
+        double t = 2 * 3.14159265358979323846 * k / n;
+        pixels[k] = {(int)std::lround(rx * std::cos(t)), (int)std::lround(ry * std::sin(t))};
+    }
+    std::sort(pixels.begin(), pixels.end());
+    pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+    return pixels;
+}
+
+static std::vector<Point> elipseImplicita(int rx, int ry) {
+    std::vector<Point> pixels;
+    const double a2 = (double)rx * rx, b2 = (double)ry * ry;
+    auto f = [&](double x, double y) { return x * x / a2 + y * y / b2 - 1; };
+    for (int y = -ry; y <= ry; y++) {
+        for (int x = -rx; x <= rx; x++) {
+            double c[4] = {f(x - 0.5, y - 0.5), f(x + 0.5, y - 0.5), f(x - 0.5, y + 0.5), f(x + 0.5, y + 0.5)};
+            bool dentro = false, fora = false;
+            for (double v : c) (v <= 0 ? dentro : fora) = true;
+            if (dentro && fora) pixels.push_back({x, y});
+        }
+    }
+    return pixels;
+}
+
+static void benchElipses() {
+    if (!selecionado("elipse")) return;
+    cabecalho("elipse (ry = 3rx/8)", "rx", "ns/pixel");
+    std::vector<Point> pixels;
+    std::vector<Span> spans;
+    for (int rx : {16, 256, 4096, 65536}) {
+        const int ry = rx * 3 / 8;
+        const ShapeSpec e = parseShape({{"xc", 0}, {"yc", 0}, {"rx", rx}, {"ry", ry}}, "elipse");
+        const size_t n = rasterizePoints(e).size();
+        linha("rasterizePoints (elipse)", rx, medir([&] { g_sumidouro = rasterizePoints(e).size(); }), n);
+        // mesmo caminho do streaming: só o iterador, sem vetor
+        linha("ellipsePixels (iterador)", rx, medir([&] {
+            size_t k = 0;
+            ellipsePixels(0, 0, rx, ry, ContadorPixels(k));
+            g_sumidouro = k;
+        }), n);
+        linha("ellipseSpans", rx, medir([&] {
+            spans.clear();
+            ellipseSpans(0, 0, rx, ry, std::back_inserter(spans));
+        }), n);
+        std::vector<Point> param = elipseParametrica(rx, ry);
+        linha("  amostragem paramétrica", rx, medir([&] { g_sumidouro = elipseParametrica(rx, ry).size(); }), n);
+        if (rx <= 256)
+            linha("  teste implícito na caixa", rx, medir([&] { g_sumidouro = elipseImplicita(rx, ry).size(); }), n);
+        // a amostragem repete pixels e cria degraus em L onde o ponto médio dá diagonal
+        std::vector<Point> meio = rasterizePoints(e);
+        std::sort(meio.begin(), meio.end());
+        std::vector<Point> so;
+        std::set_difference(param.begin(), param.end(), meio.begin(), meio.end(), std::back_inserter(so));
+        std::printf("  rx %d: %zu pixels, %zu spans; paramétrica dá %zu pixels (%zu fora do ponto médio)\n",
+                    rx, n, spans.size(), param.size(), so.size());
+    }
+}
+
+// Lote de linhas em que `taxa` delas cruza a janela [0,100]x[0,100] e o
+// resto fica inteiramente à esquerda (rejeição trivial).
+struct Segmento {
+    double x1, y1, x2, y2;
+};
+
+static std::vector<Segmento> gerarSegmentos(double taxa, size_t n) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::uniform_real_distribution<double> fora(-500.0, -1.0);
+    std::uniform_real_distribution<double> coord(-50.0, 150.0);
+    std::vector<Segmento> segs;
+    segs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (u(gen) < taxa)
+            segs.push_back({-50.0, coord(gen), 150.0, coord(gen)}); // atravessa a janela
+        else
+            segs.push_back({fora(gen), coord(gen), fora(gen), coord(gen)});
+    }
+    return segs;
+}
+
+static void benchRecorte() {
+    if (!selecionado("recorte")) return;
+    cabecalho("recorte (1000 segmentos)", "% aceitos", "ns/segmento");
+    const size_t n = 1000;
+    for (int pct : {0, 25, 50, 75, 100}) {
+        std::vector<Segmento> segs = gerarSegmentos(pct / 100.0, n);
+        double ox1, oy1, ox2, oy2;
+        auto lote = [&](bool (*fn)(double, double, double, double, double, double, double, double,
+                                   double&, double&, double&, double&)) {
+            size_t aceitos = 0;
+            for (const auto& s : segs)
+                aceitos += fn(s.x1, s.y1, s.x2, s.y2, 0, 0, 100, 100, ox1, oy1, ox2, oy2);
+            g_sumidouro = aceitos;
+        };
+        linha("cohen_sutherland_clip", pct, medir([&] { lote(cohen_sutherland_clip); }), n);
+        linha("liang_barsky_clip", pct, medir([&] { lote(liang_barsky_clip); }), n);
+    }
+}
+
+// Recorte de 10k linhas pela mesma janela: recortarCena (rejeição/aceitação
+// trivial pela caixa) vs recortar() item a item. Inclui a rasterização em
+// spans dos aceitos.
+static void benchRecorteCena() {
+    if (!selecionado("recorte")) return;
+    cabecalho("recorte cena (10000 linhas)", "% aceitos", "ns/linha");
+    const size_t n = 10000;
+    const ClipRect janela = {0, 0, 100, 100};
+    for (int pct : {0, 25, 50, 75, 100}) {
+        std::vector<ShapeSpec> formas;
+        std::vector<ClipSpec> clips;
+        for (const auto& seg : gerarSegmentos(pct / 100.0, n)) {
+            ShapeSpec s;
+            s.linha = {(int)seg.x1, (int)seg.y1, (int)seg.x2, (int)seg.y2, LineAlgorithm::Bresenham};
+            formas.push_back(s);
+            ClipSpec c;
+            c.x1 = s.linha.x1; c.y1 = s.linha.y1; c.x2 = s.linha.x2; c.y2 = s.linha.y2;
+            c.xmin = janela.xmin; c.ymin = janela.ymin; c.xmax = janela.xmax; c.ymax = janela.ymax;
+            clips.push_back(c);
+        }
+        linha("recortarCena", pct, medir([&] { g_sumidouro = recortarCena(formas, janela, 0, true).indices.size(); }), n);
+        // a referência guarda os resultados, como o servidor precisa fazer
+        linha("  recortar (um a um)", pct, medir([&] {
+            std::vector<ClipResult> resultados;
+            for (const auto& c : clips) {
+                ClipResult r = recortar(c, true);
+                if (r.aceita) resultados.push_back(std::move(r));
+            }
+            g_sumidouro = resultados.size();
+        }), n);
+    }
+}
+
+static void benchTransformacoes() {
+    if (!selecionado("transformacao")) return;
+    cabecalho("transformacao", "-", "ns/objeto");
+    const ShapeSpec linhaObj = parseShape({{"x1", -40}, {"y1", 10}, {"x2", 120}, {"y2", 75}}, "linha");
+    const ShapeSpec circuloObj = parseShape({{"xc", 10}, {"yc", -20}, {"r", 50}}, "circulo");
+    const std::pair<const char*, json> casos[] = {
+        {"translacao", {{"dx", 5}, {"dy", -3}}},
+        {"escala", {{"sx", 1.5}, {"sy", 0.5}}},
+        {"rotacao", {{"angulo", 30.0}}},
+        {"reflexao", {{"eixo", "x"}}},
+    };
+    for (const auto& caso : casos) {
+        const TransformSpec t = parseTransform(caso.first, caso.second);
+        std::string nomeLinha = std::string("linha/") + caso.first;
+        std::string nomeCirculo = std::string("circulo/") + caso.first;
+        linha(nomeLinha, 0, medir([&] { g_sumidouro = aplicarTransformacao(linhaObj, t).linha.x2; }), 1);
+        linha(nomeCirculo, 0, medir([&] { g_sumidouro = aplicarTransformacao(circuloObj, t).circulo.r; }), 1);
+    }
+
+    // Sessão de arrastar/rotacionar: N passos de rotação. Passo a passo
+    // rasteriza a cada edição; a sequência compõe a matriz e rasteriza uma vez.
+    cabecalho("transformacao sequencia", "passos", "ns/passo");
+    const ShapeSpec longa = parseShape({{"x1", -300}, {"y1", -40}, {"x2", 300}, {"y2", 120}}, "linha");
+    for (int n : {1, 10, 100}) {
+        std::vector<TransformSpec> passos(n, parseTransform("rotacao", {{"angulo", 3.0}}));
+        linha("passo a passo + raster", n, medir([&] {
+            ShapeSpec s = longa;
+            for (const auto& t : passos) {
+                s = aplicarTransformacao(s, t);
+                g_sumidouro = rasterizePoints(s).size();
+            }
+        }), n);
+        linha("aplicarSequencia + raster", n, medir([&] {
+            g_sumidouro = rasterizePoints(aplicarSequencia(longa, passos)).size();
+        }), n);
+    }
+}
+
+// Seleção por retângulo numa cena de 100k objetos (linhas curtas e
+// círculos pequenos espalhados em 20000x20000), grade vs varredura linear.
+static void benchSelecao() {
+    if (!selecionado("selecao")) return;
+    cabecalho("selecao (100k objetos)", "lado", "ns/objeto");
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> pos(-10000, 10000);
+    std::uniform_int_distribution<int> delta(-50, 50);
+    std::uniform_int_distribution<int> raio(1, 40);
+    Scene cena;
+    for (int i = 0; i < 100000; i++) {
+        ShapeSpec s;
+        int x = pos(gen), y = pos(gen);
+        if (i % 4 == 0) {
+            s.tipo = ShapeType::Circulo;
+            s.circulo = {x, y, raio(gen)};
+        } else {
+            s.linha = {x, y, x + delta(gen), y + delta(gen), LineAlgorithm::Bresenham};
+        }
+        cena.inserir(s);
+    }
+
+    for (int lado : {100, 1000, 5000}) {
+        std::vector<ClipRect> janelas;
+        for (int i = 0; i < 64; i++) {
+            double x = pos(gen), y = pos(gen);
+            janelas.push_back({x, y, x + lado, y + lado});
+        }
+        size_t k = 0, encontrados = 0;
+        for (const auto& j : janelas) encontrados += cena.selecionar(j).size();
+        linha("Scene::selecionar (grade)", lado,
+              medir([&] { g_sumidouro = cena.selecionar(janelas[k++ % janelas.size()]).size(); }),
+              std::max<double>(1.0, encontrados / (double)janelas.size()));
+
+        // Referência: teste exato em todos os objetos
+        auto linear = [&](const ClipRect& j) {
+            size_t n = 0;
+            for (const auto& s : cena.formas()) n += intersectaJanela(s, j);
+            return n;
+        };
+        linha("  referencia (linear)", lado, medir([&] { g_sumidouro = linear(janelas[k++ % janelas.size()]); }),
+              std::max<double>(1.0, encontrados / (double)janelas.size()));
+    }
+}
+
+// Pincel: os mesmos círculos e linhas redesenhados em posições aleatórias,
+// serializados em binário. Com o cache de stencils só a serialização roda.
+static void benchStencil() {
+    if (!selecionado("stencil")) return;
+    cabecalho("stencil (pincel, binario)", "r", "ns/pixel");
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> pos(-2000, 2000);
+    for (int r : {4, 16, 64, 256}) {
+        std::vector<ShapeSpec> formas;
+        for (int i = 0; i < 256; i++) {
+            ShapeSpec s;
+            int x = pos(gen), y = pos(gen);
+            if (i % 2 == 0) {
+                s.tipo = ShapeType::Circulo;
+                s.circulo = {x, y, r};
+            } else {
+                s.linha = {x, y, x + r, y + r / 3 * (i % 4 == 1 ? 1 : -1), LineAlgorithm::Bresenham};
+            }
+            formas.push_back(s);
+        }
+        size_t pixels = 0;
+        for (const auto& s : formas) pixels += rasterizeAs(s, false).tamanho();
+
+        StencilCache cache;
+
+        std::string out;
+        size_t k = 0;
+        const double porForma = pixels / (double)formas.size();
+        linha("cache de stencils", r, medir([&] {
+            out.clear();
+            appendRasterBinary(out, cache.rasterizar(formas[k++ % formas.size()], false), PixelFormat::Int32);
+        }), porForma);
+        linha("  referencia (rasterizeAs)", r, medir([&] {
+            out.clear();
+            appendRasterBinary(out, rasterizeAs(formas[k++ % formas.size()], false), PixelFormat::Int32);
+        }), porForma);
+        StencilCache::Stats st = cache.estatisticas();
+        std::printf("  hits %llu, misses %llu, entradas %zu\n",
+                    (unsigned long long)st.hits, (unsigned long long)st.misses, st.entradas);
+    }
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--tempo") == 0 && i + 1 < argc)
+            g_alvoMs = std::atof(argv[++i]);
+        else
+            g_filtro = argv[i];
+    }
+
+    benchLinhas();
+    benchRunSlice();
+    benchDda();
+    benchLinhaGrossa();
+    benchLinhaParalela();
+    benchWu();
+    benchCirculos();
+    benchDiscos();
+    benchElipses();
+    benchRecorte();
+    benchRecorteCena();
+    benchTransformacoes();
+    benchSelecao();
+    benchStencil();
+    return 0;
+}
@@ -0,0 +1,367 @@
+// Verificações de correção dos algoritmos, separadas do benchmark. Cada
+// verificação compara um kernel com uma referência independente (ou com a
+// outra versão do mesmo algoritmo) em muitos casos. Uso:
+//   make check
+//   ./bin/check [filtro]
+// `filtro` restringe às verificações cujo nome contém o texto (ex.: "dda").
+// Sai com código 1 se alguma verificação falhar.
+#include "../algorithms.h"
+#include "../encoding.h"
+#include "../scene.h"
+#include "../stencil.h"
+#include "referencias.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Descreve o primeiro caso que falhou; a verificação retorna false em seguida
+static bool falha(const char* fmt, ...) {
+    std::va_list args;
+    va_start(args, fmt);
+    std::printf("FALHOU: ");
+    std::vprintf(fmt, args);
+    std::printf("\n");
+    va_end(args);
+    return false;
+}
+
+static bool spansIguais(const std::vector<Span>& a, const std::vector<Span>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); k++)
+        if (a[k].y != b[k].y || a[k].x0 != b[k].x0 || a[k].x1 != b[k].x1) return false;
+    return true;
+}
+
+// ---- Verificações ----
+
+// Vetor e iterador dão o mesmo contorno, igual à versão com sort/unique
+static bool checarCirculo() {
+    std::vector<int> raios;
+    for (int r = 0; r <= 300; r++) raios.push_back(r);
+    for (int r : {1000, 10000, 100000}) raios.push_back(r);
+    for (int r : raios) {
+        std::vector<Point> novo = bresenhamCircle(0, 0, r);
+        std::vector<Point> iterador;
+        bresenhamCircle(0, 0, r, std::back_inserter(iterador));
+        bool ok = iterador == novo;
+        std::sort(novo.begin(), novo.end());
+        if (!ok || novo != bresenhamCircleOrdenado(0, 0, r))
+            return falha("bresenhamCircle difere da referência para r=%d", r);
+    }
+    return true;
+}
+
+// Linhas longas divididas entre threads saem iguais à sequencial
+static bool checarLinhaParalela() {
+    for (int dx : {1000000, 3000017}) {
+        int dy = dx / 3 + 7;
+        const size_t n = lineLength(0, 0, dx, dy);
+        std::vector<Point> seq(n), par(n);
+        bresenhamLine(0, 0, dx, dy, seq.data());
+        for (unsigned partes : {2u, 3u, 4u, 8u}) {
+            bresenhamLineParallel(0, 0, dx, dy, par.data(), partes);
+            if (par != seq)
+                return falha("linha paralela (%u partes) difere da sequencial para dx=%d", partes, dx);
+        }
+    }
+    return true;
+}
+
+// Todos os kernels do DDA (até o nível da CPU) conferem com o
+// arredondamento da razão exata
+static bool checarDda() {
+    static const SimdLevel NIVEIS[] = {SimdLevel::Escalar, SimdLevel::Sse2, SimdLevel::Avx2};
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> curta(-300, 300), longa(-2000000, 2000000);
+    std::vector<Point> buf;
+    for (int i = 0; i < 20000; i++) {
+        int x1 = curta(gen), y1 = curta(gen), x2 = curta(gen), y2 = curta(gen);
+        if (i < 6561) { x1 = y1 = 0; x2 = i % 81 - 40; y2 = i / 81 - 40; }
+        if (i % 1000 == 999) { x1 = longa(gen); y1 = longa(gen); x2 = longa(gen); y2 = longa(gen); }
+        const size_t n = lineLength(x1, y1, x2, y2);
+        std::vector<Point> ref(n);
+        for (size_t k = 0; k < n; k++) ref[k] = ddaReferencia(x1, y1, x2, y2, (long long)k);
+
+        buf.clear();
+        dda(x1, y1, x2, y2, std::back_inserter(buf));
+        bool ok = buf == ref;
+        for (SimdLevel nivel : NIVEIS) {
+            if (nivel > ddaSimdLevel()) break;
+            buf.assign(n, Point{0, 0});
+            ok = ok && ddaKernel(nivel, x1, y1, x2, y2, buf.data()) == buf.data() + n && buf == ref;
+        }
+        if (!ok) return falha("dda difere do arredondamento exato em (%d,%d)-(%d,%d)", x1, y1, x2, y2);
+    }
+    return true;
+}
+
+// Run-slice confere com Bresenham (pixels e spans) em todas as direções
+static bool checarRunSlice() {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> d(-3000, 3000);
+    for (int i = 0; i < 20000; i++) {
+        int x1 = d(gen), y1 = d(gen), x2 = d(gen), y2 = d(gen);
+        if (i < 6561) { x1 = y1 = 0; x2 = i % 81 - 40; y2 = i / 81 - 40; }
+        std::vector<Point> ref, rs;
+        bresenhamLine(x1, y1, x2, y2, std::back_inserter(ref));
+        runSliceLine(x1, y1, x2, y2, std::back_inserter(rs));
+        std::vector<Span> spansRef, spansRs;
+        std::copy(ref.begin(), ref.end(), SpanInserter(spansRef));
+        runSliceSpans(x1, y1, x2, y2, std::back_inserter(spansRs));
+        if (ref != rs || !spansIguais(spansRef, spansRs))
+            return falha("run-slice difere de Bresenham em (%d,%d)-(%d,%d)", x1, y1, x2, y2);
+    }
+    return true;
+}
+
+// Wu inteiro: posições e cobertura batem com a conta exata floor(256*frac)
+// (a referência em double erra por no máximo 1), cada passo soma 255, e
+// linhas horizontais, verticais e a 45 graus saem iguais ao Bresenham
+static bool checarWu() {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> coord(-300, 300);
+    std::vector<PixelAlfa> wu, ref;
+    for (int caso = 0; caso < 20000; caso++) {
+        int x1 = coord(gen), y1 = coord(gen), x2 = coord(gen), y2 = coord(gen);
+        if (caso % 4 == 0) y2 = y1;
+        if (caso % 4 == 1) x2 = x1 + (y2 - y1) * (caso % 8 == 1 ? 1 : -1);
+        wu.clear();
+        ref.resize(2 * lineLength(x1, y1, x2, y2));
+        wuLine(x1, y1, x2, y2, std::back_inserter(wu));
+        ref.resize(wuFloat(x1, y1, x2, y2, ref.data()) - ref.data());
+        bool igual = wu.size() == ref.size();
+        for (size_t i = 0; igual && i < wu.size(); i++)
+            igual = wu[i].x == ref[i].x && wu[i].y == ref[i].y && std::abs(wu[i].a - ref[i].a) <= 1;
+        // pares (perto, longe) do mesmo passo somam 255; passo isolado é 255
+        for (size_t i = 0; igual && i < wu.size(); i++) {
+            bool par = i + 1 < wu.size() && wu[i].a != 255 && wu[i].a + wu[i + 1].a == 255;
+            if (par) i++;
+            else igual = wu[i].a == 255;
+        }
+        const long long dx = std::llabs((long long)x2 - x1), dy = std::llabs((long long)y2 - y1);
+        if (igual && (dx == 0 || dy == 0 || dx == dy)) {
+            std::vector<Point> b = bresenhamLine(x1, y1, x2, y2);
+            igual = b.size() == wu.size();
+            for (size_t i = 0; igual && i < b.size(); i++)
+                igual = b[i] == Point{wu[i].x, wu[i].y} && wu[i].a == 255;
+        }
+        if (!igual) return falha("linha wu difere da referência para (%d,%d)-(%d,%d)", x1, y1, x2, y2);
+    }
+    return true;
+}
+
+// diskSpans/diskPixels cobrem exatamente o contorno preenchido, com uma
+// scanline por y
+static bool checarDisco() {
+    for (int r = -3; r <= 2000; r++) {
+        std::vector<Span> spans;
+        diskSpans(3, -7, r, std::back_inserter(spans));
+        std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.y < b.y; });
+        std::vector<Span> ref = discoPorContorno(3, -7, r);
+        size_t area = 0, n = 0;
+        for (const Span& sp : ref) area += (size_t)(sp.x1 - sp.x0 + 1);
+        diskPixels(3, -7, r, ContadorPixels(n));
+        if (!spansIguais(spans, ref) || n != area)
+            return falha("disco difere do contorno preenchido para r=%d", r);
+    }
+    return true;
+}
+
+// Elipse: o quarto é 8-conexo de (0, ry) a (rx, 0), a versão de 128 bits
+// dá os mesmos pontos, pixels/spans cobrem o contorno sem repetição e a
+// preenchida cobre de ponta a ponta cada linha do contorno
+static bool checarElipse() {
+    for (int rx = 0; rx <= 64; rx++) {
+        for (int ry = 0; ry <= 64; ry++) {
+            std::vector<Point> q64, q128;
+            ellipseQuarterPoints<long long>(rx, ry, [&](long long x, long long y) { q64.push_back({(int)x, (int)y}); });
+            ellipseQuarterPoints<__int128>(rx, ry, [&](__int128 x, __int128 y) { q128.push_back({(int)x, (int)y}); });
+            bool ok = q64 == q128 && q64.front() == Point{0, ry} && q64.back() == Point{rx, 0};
+            for (size_t k = 1; ok && k < q64.size(); k++) {
+                int dx = q64[k].first - q64[k - 1].first, dy = q64[k - 1].second - q64[k].second;
+                ok = dx >= 0 && dy >= 0 && dx <= 1 && dy <= 1 && dx + dy > 0;
+            }
+            std::vector<Point> pixels = rasterizePoints(parseShape({{"xc", 0}, {"yc", 0}, {"rx", rx}, {"ry", ry}}, "elipse"));
+            std::vector<Span> spans;
+            ellipseSpans(0, 0, rx, ry, std::back_inserter(spans));
+            std::vector<Point> dosSpans;
+            for (const Span& sp : spans)
+                for (int x = sp.x0; x <= sp.x1; x++) dosSpans.push_back({x, sp.y});
+            std::sort(pixels.begin(), pixels.end());
+            std::sort(dosSpans.begin(), dosSpans.end());
+            ok = ok && std::adjacent_find(pixels.begin(), pixels.end()) == pixels.end() && pixels == dosSpans;
+            // a preenchida tem uma scanline por y, do primeiro ao último
+            // pixel do contorno nela (pixels está ordenado por x, depois y)
+            std::vector<Span> cheia, ref;
+            filledEllipseSpans(0, 0, rx, ry, std::back_inserter(cheia));
+            for (int y = -ry; y <= ry; y++) {
+                Span sp{y, 0, -1};
+                for (Point p : pixels) {
+                    if (p.second != y) continue;
+                    if (sp.x0 > sp.x1) sp.x0 = sp.x1 = p.first;
+                    else sp.x1 = p.first;
+                }
+                ref.push_back(sp);
+            }
+            auto porY = [](const Span& a, const Span& b) { return a.y < b.y; };
+            std::sort(cheia.begin(), cheia.end(), porY);
+            ok = ok && spansIguais(cheia, ref);
+            if (!ok) return falha("elipse inválida para rx=%d ry=%d", rx, ry);
+        }
+    }
+    return true;
+}
+
+// Linha grossa: os spans cobrem exatamente os pixels com centro na forma
+// (amostragem pixel a pixel), com um span por scanline, em y crescente e
+// sem sobreposição; thickLinePixels dá os mesmos pixels
+static bool checarLinhaGrossa() {
+    static const LineCap PONTAS[] = {LineCap::Reta, LineCap::Quadrada, LineCap::Redonda};
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> pos(-1000, 1000), delta(-40, 40), largura(2, 13);
+    for (int i = 0; i < 6000; i++) {
+        int x = pos(gen), y = pos(gen);
+        // alguns casos horizontais, verticais, diagonais e de comprimento zero
+        int dx = delta(gen), dy = i % 7 == 0 ? 0 : i % 7 == 1 ? dx : i % 7 == 2 ? -dx : delta(gen);
+        if (i % 11 == 0) dx = 0;
+        if (i % 29 == 0) dx = dy = 0;
+        LineSpec l{x, y, x + dx, y + dy, LineAlgorithm::Bresenham, largura(gen), PONTAS[i % 3]};
+        std::vector<Span> spans;
+        thickLineSpans(l, std::back_inserter(spans));
+        std::vector<Point> dosSpans;
+        bool ok = true;
+        for (size_t k = 0; k < spans.size(); k++) {
+            ok = ok && spans[k].x0 <= spans[k].x1 && (k == 0 || spans[k].y > spans[k - 1].y);
+            for (int px = spans[k].x0; px <= spans[k].x1; px++) dosSpans.push_back({px, spans[k].y});
+        }
+        std::vector<Point> pixels;
+        thickLinePixels(l, std::back_inserter(pixels));
+        std::sort(dosSpans.begin(), dosSpans.end());
+        std::sort(pixels.begin(), pixels.end());
+        ok = ok && dosSpans == linhaGrossaPorAmostragem(l) && pixels == dosSpans;
+        if (!ok)
+            return falha("linha grossa difere da amostragem para (%d,%d)-(%d,%d) largura %d ponta %d",
+                         l.x1, l.y1, l.x2, l.y2, l.largura, (int)l.ponta);
+    }
+    return true;
+}
+
+// Seleção pela grade dá os mesmos ids do teste exato em todos os objetos,
+// e o teste da linha grossa aceita toda janela com um pixel dela dentro
+static bool checarSelecao() {
+    static const LineCap PONTAS[] = {LineCap::Reta, LineCap::Quadrada, LineCap::Redonda};
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> pos(-5000, 5000), delta(-300, 300), raio(1, 400);
+    Scene cena;
+    for (int i = 0; i < 20000; i++) {
+        ShapeSpec s;
+        int x = pos(gen), y = pos(gen);
+        if (i % 4 == 0) {
+            s.tipo = i % 8 == 0 ? ShapeType::Circulo : ShapeType::Disco;
+            s.circulo = {x, y, raio(gen)};
+        } else if (i % 4 == 1) {
+            s.tipo = ShapeType::Elipse;
+            s.elipse = {x, y, raio(gen), raio(gen), i % 8 == 5};
+        } else {
+            s.linha = {x, y, x + delta(gen), y + delta(gen), LineAlgorithm::Bresenham, 1 + i % 9, PONTAS[i % 3]};
+        }
+        cena.inserir(s);
+    }
+    std::uniform_int_distribution<int> curto(-30, 30), canto(-45, 45);
+    for (int i = 0; i < 20000; i++) {
+        LineSpec l{0, 0, curto(gen), curto(gen), LineAlgorithm::Bresenham, 2 + i % 12, PONTAS[i % 3]};
+        // limites fracionários: nenhum centro de pixel cai na borda da janela
+        double x = canto(gen) + 0.25, y = canto(gen) + 0.25;
+        ClipRect j = {x, y, x + 1 + i % 5, y + 1 + i % 7};
+        std::vector<Point> pixels;
+        thickLinePixels(l, std::back_inserter(pixels));
+        bool algum = false;
+        for (Point p : pixels) algum = algum || (p.first >= j.xmin && p.first <= j.xmax && p.second >= j.ymin && p.second <= j.ymax);
+        ShapeSpec s;
+        s.linha = l;
+        if (algum && !intersectaJanela(s, j))
+            return falha("linha grossa (0,0)-(%d,%d) largura %d ponta %d com pixel na janela não foi selecionada",
+                         l.x2, l.y2, l.largura, (int)l.ponta);
+    }
+    for (int lado : {10, 100, 1000, 5000}) {
+        for (int i = 0; i < 64; i++) {
+            double x = pos(gen) + 0.5 * (i % 2), y = pos(gen);
+            ClipRect j = {x, y, x + lado, y + lado};
+            std::vector<Scene::Id> linear;
+            for (size_t k = 0; k < cena.formas().size(); k++)
+                if (intersectaJanela(cena.formas()[k], j)) linear.push_back(cena.ids()[k]);
+            std::sort(linear.begin(), linear.end());
+            if (cena.selecionar(j) != linear)
+                return falha("seleção pela grade difere da varredura linear (lado %d)", lado);
+        }
+    }
+    return true;
+}
+
+// O cache de stencils serializa igual à rasterização direta
+static bool checarStencil() {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> pos(-2000, 2000);
+    static const LineAlgorithm ALGORITMOS[] = {LineAlgorithm::Bresenham, LineAlgorithm::Dda,
+                                               LineAlgorithm::RunSlice, LineAlgorithm::Wu};
+    StencilCache cache;
+    std::string a, b;
+    for (int i = 0; i < 4000; i++) {
+        ShapeSpec s;
+        int x = pos(gen), y = pos(gen), r = 1 + i % 97;
+        if (i % 4 == 0) {
+            s.tipo = i % 8 == 0 ? ShapeType::Circulo : ShapeType::Disco;
+            s.circulo = {x, y, r};
+        } else if (i % 4 == 1) {
+            s.tipo = ShapeType::Elipse;
+            s.elipse = {x, y, r, 1 + i % 31, i % 8 == 5};
+        } else {
+            s.linha = {x, y, x + r, y - r / 3, ALGORITMOS[i % 4], i % 3 == 0 ? 5 : 1, LineCap::Redonda};
+        }
+        for (bool emSpans : {false, true}) {
+            a.clear(); b.clear();
+            appendRasterBinary(a, rasterizeAs(s, emSpans), PixelFormat::Int32);
+            appendRasterBinary(b, cache.rasterizar(s, emSpans), PixelFormat::Int32);
+            if (a != b) return falha("stencil difere da rasterização direta (objeto %d)", i);
+        }
+    }
+    return true;
+}
+
+struct Verificacao {
+    const char* nome;
+    bool (*fn)();
+};
+
+static const Verificacao VERIFICACOES[] = {
+    {"circulo", checarCirculo},
+    {"linha paralela", checarLinhaParalela},
+    {"dda", checarDda},
+    {"runslice", checarRunSlice},
+    {"wu", checarWu},
+    {"disco", checarDisco},
+    {"elipse", checarElipse},
+    {"linha grossa", checarLinhaGrossa},
+    {"selecao", checarSelecao},
+    {"stencil", checarStencil},
+};
+
+int main(int argc, char** argv) {
+    std::string filtro = argc > 1 ? argv[1] : "";
+    int falhas = 0, executadas = 0;
+    for (const Verificacao& v : VERIFICACOES) {
+        if (!filtro.empty() && std::string(v.nome).find(filtro) == std::string::npos) continue;
+        std::printf("%-20s ", v.nome);
+        std::fflush(stdout);
+        bool ok = v.fn();
+        if (ok) std::printf("ok\n");
+        falhas += !ok;
+        executadas++;
+    }
+    std::printf("%d verificações, %d falhas\n", executadas, falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+// Implementações de referência usadas pelo benchmark (como base de
+// comparação de tempo) e pelas verificações de correção (make check).
+#ifndef BENCH_REFERENCIAS_H
+#define BENCH_REFERENCIAS_H
+
+#include "../algorithms.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// Implementação anterior do círculo (8 pontos por passo + sort/unique),
+// mantida como referência de comparação.
+inline std::vector<Point> bresenhamCircleOrdenado(int xc, int yc, int r) {
+    std::vector<Point> pixels;
+    int x, y, p;
+    auto plot_circle_points = [&]() {
+        pixels.push_back({xc + x, yc + y});
+        pixels.push_back({xc - x, yc + y});
+        pixels.push_back({xc + x, yc - y});
+        pixels.push_back({xc - x, yc - y});
+        pixels.push_back({xc + y, yc + x});
+        pixels.push_back({xc - y, yc + x});
+        pixels.push_back({xc + y, yc - x});
+        pixels.push_back({xc - y, yc - x});
+    };
+    x = 0;
+    y = r;
+    p = 3 - 2 * r;
+    plot_circle_points();
+    while (x < y) {
+        if (p < 0) {
+            p = p + 4 * x + 6;
+        } else {
+            p = p + 4 * (x - y) + 10;
+            y = y - 1;
+        }
+        x = x + 1;
+        plot_circle_points();
+    }
+    std::sort(pixels.begin(), pixels.end());
+    pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+    return pixels;
+}
+
+// Iterador de saída que só conta os pixels
+struct ContadorPixels {
+    size_t* n;
+    explicit ContadorPixels(size_t& k) : n(&k) {}
+    ContadorPixels& operator=(const Point&) { ++*n; return *this; }
+    ContadorPixels& operator*() { return *this; }
+    ContadorPixels& operator++() { return *this; }
+    ContadorPixels& operator++(int) { return *this; }
+};
+
+// DDA com float (versão anterior), para comparar velocidade e deriva
+inline Point* ddaFloat(int x1, int y1, int x2, int y2, Point* out) {
+    int dx = x2 - x1, dy = y2 - y1;
+    int passos = std::max(std::abs(dx), std::abs(dy));
+    if (passos == 0) { *out++ = Point{x1, y1}; return out; }
+    float xi = dx / (float)passos, yi = dy / (float)passos, x = x1, y = y1;
+    *out++ = Point{(int)std::round(x), (int)std::round(y)};
+    for (int k = 1; k <= passos; k++) {
+        x += xi;
+        y += yi;
+        *out++ = Point{(int)std::round(x), (int)std::round(y)};
+    }
+    return out;
+}
+
+// Pixel k pelo arredondamento da razão exata: inicio + floor((2kd + n) / 2n)
+inline Point ddaReferencia(int x1, int y1, int x2, int y2, long long k) {
+    long long dx = (long long)x2 - x1, dy = (long long)y2 - y1;
+    long long n = std::max(std::llabs(dx), std::llabs(dy));
+    if (n == 0) return {x1, y1};
+    return {(int)(x1 + divPiso(2 * k * dx + n, 2 * n)), (int)(y1 + divPiso(2 * k * dy + n, 2 * n))};
+}
+
+// Wu em ponto flutuante (como costuma ser escrito): t = k*menor/maior,
+// parte inteira dá o pixel e a fração a cobertura do vizinho
+inline PixelAlfa* wuFloat(int x1, int y1, int x2, int y2, PixelAlfa* out) {
+    const int dx = std::abs(x2 - x1), dy = std::abs(y2 - y1);
+    const bool xMaior = dy < dx;
+    const int maior = xMaior ? dx : dy, menor = xMaior ? dy : dx;
+    const int sMaior = (xMaior ? x2 >= x1 : y2 >= y1) ? 1 : -1;
+    const int sMenor = (xMaior ? y2 >= y1 : x2 >= x1) ? 1 : -1;
+    for (int k = 0; k <= maior; k++) {
+        // sem acumular t += inc: a soma deriva e erra o pixel nos inteiros
+        double t = maior ? (double)k * menor / maior : 0.0;
+        int m = (int)t;
+        int a = (int)(256 * (t - m));
+        if (a > 255) a = 255;
+        int M = (xMaior ? x1 : y1) + k * sMaior, mm = (xMaior ? y1 : x1) + m * sMenor;
+        *out++ = xMaior ? PixelAlfa{M, mm, (uint8_t)(255 - a)} : PixelAlfa{mm, M, (uint8_t)(255 - a)};
+        if (a) *out++ = xMaior ? PixelAlfa{M, mm + sMenor, (uint8_t)a} : PixelAlfa{mm + sMenor, M, (uint8_t)a};
+    }
+    return out;
+}
+
+// Referência do disco: contorno do bresenhamCircle() ordenado e cada
+// scanline preenchida do primeiro ao último pixel dela
+inline std::vector<Span> discoPorContorno(int xc, int yc, int r) {
+    std::vector<Point> contorno = bresenhamCircle(xc, yc, r < 0 ? -r : r);
+    std::sort(contorno.begin(), contorno.end(), [](Point a, Point b) {
+        return a.second != b.second ? a.second < b.second : a.first < b.first;
+    });
+    std::vector<Span> spans;
+    for (Point p : contorno) {
+        if (!spans.empty() && spans.back().y == p.second) spans.back().x1 = p.first;
+        else spans.push_back({p.second, p.first, p.first});
+    }
+    return spans;
+}
+
+// Referência da linha grossa por amostragem: testa o centro de cada pixel
+// da caixa envolvente contra o retângulo do corpo (mais a extensão da ponta
+// quadrada) e, com ponta redonda, contra os dois discos das pontas. As
+// expressões são as mesmas do ThickLine, pixel a pixel, então os empates
+// nas bordas caem do mesmo lado. Devolve os pixels ordenados.
+inline std::vector<Point> linhaGrossaPorAmostragem(const LineSpec& l) {
+    const long long dx = (long long)l.x2 - l.x1, dy = (long long)l.y2 - l.y1;
+    const double comprimento = std::sqrt((double)dx * dx + (double)dy * dy);
+    const double ux = comprimento > 0 ? dx / comprimento : 1.0, uy = comprimento > 0 ? dy / comprimento : 0.0;
+    const double meia = l.largura / 2.0;
+    const bool quadrada = l.ponta == LineCap::Quadrada || (l.ponta == LineCap::Reta && comprimento == 0);
+    const double extensao = quadrada ? meia : 0.0;
+    const long long w2 = (long long)l.largura * l.largura;
+    auto noDisco = [&](long long rx, long long ry) { return 4 * (rx * rx + ry * ry) < w2; };
+
+    const int m = l.largura + 2;
+    std::vector<Point> pixels;
+    for (int y = std::min(l.y1, l.y2) - m; y <= std::max(l.y1, l.y2) + m; y++) {
+        for (int x = std::min(l.x1, l.x2) - m; x <= std::max(l.x1, l.x2) + m; x++) {
+            const long long rx = (long long)x - l.x1, ry = (long long)y - l.y1;
+            const double t = ux * (double)rx + ry * uy, d = -uy * (double)rx + ry * ux;
+            bool dentro = -extensao <= t && t < comprimento + extensao && -meia <= d && d < meia;
+            if (l.ponta == LineCap::Redonda) dentro = dentro || noDisco(rx, ry) || noDisco(rx - dx, ry - dy);
+            if (dentro) pixels.push_back({x, y});
+        }
+    }
+    std::sort(pixels.begin(), pixels.end());
+    return pixels;
+}
+
+#endif
@@ -56,6 +56,13 @@ if not exist server.cpp (
 )
 g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -o output.exe source.cpp
 
+echo [INFO] Compilando specs.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\specs.o specs.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar specs.cpp
+    exit /b 1
+)
+
 echo [INFO] Compilando algorithms.cpp...
 g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\algorithms.o algorithms.cpp
 if errorlevel 1 (
@@ -70,6 +77,62 @@ if errorlevel 1 (
     exit /b 1
 )
 
+echo [INFO] Compilando encoding.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\encoding.o encoding.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar encoding.cpp
+    exit /b 1
+)
+
+echo [INFO] Compilando framebuffer.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\framebuffer.o framebuffer.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar framebuffer.cpp
+    exit /b 1
+)
+
+echo [INFO] Compilando spatial.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\spatial.o spatial.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar spatial.cpp
+    exit /b 1
+)
+
+echo [INFO] Compilando stencil.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\stencil.o stencil.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar stencil.cpp
+    exit /b 1
+)
+
+echo [INFO] Compilando scene.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\scene.o scene.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar scene.cpp
+    exit /b 1
+)
+
+echo [INFO] Compilando config.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\config.o config.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar config.cpp
+    exit /b 1
+)
+
+echo [INFO] Compilando taskqueue.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\taskqueue.o taskqueue.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar taskqueue.cpp
+    exit /b 1
+)
+
+echo [INFO] Compilando metrics.cpp...
+g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\metrics.o metrics.cpp
+if errorlevel 1 (
+    echo [ERROR] Falha ao compilar metrics.cpp
+    exit /b 1
+)
+
 echo [INFO] Compilando server.cpp...
 g++ -D_WIN32_WINNT=0x0A00 -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\server.o server.cpp
 if errorlevel 1 (
@@ -78,7 +141,7 @@ if errorlevel 1 (
 )
 
 echo [INFO] Linkando executavel...
-g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -o bin\%PROJECT%.exe build\algorithms.o build\transformations.o build\server.o -lws2_32 -lwsock32
+g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -o bin\%PROJECT%.exe build\specs.o build\algorithms.o build\transformations.o build\encoding.o build\framebuffer.o build\spatial.o build\stencil.o build\scene.o build\config.o build\taskqueue.o build\metrics.o build\server.o -lws2_32 -lwsock32
 if errorlevel 1 (
     echo [ERROR] Falha no linking
     exit /b 1
@@ -53,17 +53,44 @@ function Build-Windows {
     Write-Info "Compilando arquivos fonte..."
     
     # Compilar
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\specs.o specs.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar specs.cpp"; return }
+    
     & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\algorithms.o algorithms.cpp
     if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar algorithms.cpp"; return }
     
     & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\transformations.o transformations.cpp
     if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar transformations.cpp"; return }
     
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\encoding.o encoding.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar encoding.cpp"; return }
+    
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\framebuffer.o framebuffer.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar framebuffer.cpp"; return }
+    
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\spatial.o spatial.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar spatial.cpp"; return }
+    
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\stencil.o stencil.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar stencil.cpp"; return }
+    
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\scene.o scene.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar scene.cpp"; return }
+    
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\config.o config.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar config.cpp"; return }
+    
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\taskqueue.o taskqueue.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar taskqueue.cpp"; return }
+    
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\metrics.o metrics.cpp
+    if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar metrics.cpp"; return }
+    
     & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -c -o build\server.o server.cpp
     if ($LASTEXITCODE -ne 0) { Write-Error "Falha ao compilar server.cpp"; return }
     
     Write-Info "Linkando executável..."
-    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -o bin\$PROJECT.exe build\algorithms.o build\transformations.o build\server.o -lws2_32 -lwsock32
+    & g++ -std=c++17 -O2 -Wall -Wextra -Ilibs -o bin\$PROJECT.exe build\specs.o build\algorithms.o build\transformations.o build\encoding.o build\framebuffer.o build\spatial.o build\stencil.o build\scene.o build\config.o build\taskqueue.o build\metrics.o build\server.o -lws2_32 -lwsock32
     if ($LASTEXITCODE -ne 0) { Write-Error "Falha no linking"; return }
     
     Write-Success "Build Windows completo! Executável: bin\$PROJECT.exe"
@@ -0,0 +1,62 @@
+#include "config.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+// Inteiro em [minimo, maximo]; `nome` identifica a opção no erro
+static long numero(const char* nome, const char* valor, long minimo, long maximo) {
+    char* fim = nullptr;
+    long v = std::strtol(valor, &fim, 10);
+    if (!*valor || *fim || v < minimo || v > maximo)
+        throw std::invalid_argument(std::string("valor inválido para ") + nome + ": '" + valor + "'");
+    return v;
+}
+
+static void aplicar(ServerConfig& cfg, const std::string& opcao, const char* valor) {
+    const char* nome = opcao.c_str();
+    if (opcao == "host") cfg.host = valor;
+    else if (opcao == "port") cfg.porta = (int)numero(nome, valor, 1, 65535);
+    else if (opcao == "threads") cfg.threads = (size_t)numero(nome, valor, 1, 1024);
+    else if (opcao == "keep-alive-max") cfg.keepAliveMax = (size_t)numero(nome, valor, 1, 1000000);
+    else if (opcao == "keep-alive-timeout") cfg.keepAliveTimeout = (time_t)numero(nome, valor, 0, 3600);
+    else throw std::invalid_argument("opção desconhecida: --" + opcao);
+}
+
+ServerConfig parseServerConfig(int argc, char** argv) {
+    ServerConfig cfg;
+    const std::pair<const char*, const char*> ambiente[] = {
+        {"PAINT_HOST", "host"},
+        {"PAINT_PORT", "port"},
+        {"PAINT_THREADS", "threads"},
+        {"PAINT_KEEPALIVE_MAX", "keep-alive-max"},
+        {"PAINT_KEEPALIVE_TIMEOUT", "keep-alive-timeout"},
+    };
+    for (const auto& [var, opcao] : ambiente) {
+        if (const char* v = std::getenv(var)) aplicar(cfg, opcao, v);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            cfg.ajuda = true;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--", 2) != 0)
+            throw std::invalid_argument(std::string("argumento inesperado: ") + argv[i]);
+        std::string opcao = argv[i] + 2;
+        if (i + 1 >= argc) throw std::invalid_argument("falta o valor de --" + opcao);
+        aplicar(cfg, opcao, argv[++i]);
+    }
+
+    if (cfg.threads == 0) cfg.threads = std::max(8u, std::thread::hardware_concurrency() > 0
+                                                         ? std::thread::hardware_concurrency() - 1 : 0);
+    return cfg;
+}
+
+const char* serverUsage() {
+    return "uso: backend [--host H] [--port P] [--threads N]\n"
+           "               [--keep-alive-max N] [--keep-alive-timeout S]\n"
+           "variáveis: PAINT_HOST, PAINT_PORT, PAINT_THREADS,\n"
+           "           PAINT_KEEPALIVE_MAX, PAINT_KEEPALIVE_TIMEOUT\n";
+}
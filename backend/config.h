@@ -0,0 +1,28 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <ctime>
+#include <string>
+
+// Configuração do servidor. Lida primeiro das variáveis de ambiente e depois
+// da linha de comando, que tem prioridade:
+//   --host H                PAINT_HOST               (padrão 0.0.0.0)
+//   --port P                PAINT_PORT               (padrão 8080)
+//   --threads N             PAINT_THREADS            (padrão max(8, núcleos - 1))
+//   --keep-alive-max N      PAINT_KEEPALIVE_MAX      requisições por conexão (padrão 100)
+//   --keep-alive-timeout S  PAINT_KEEPALIVE_TIMEOUT  segundos ociosos (padrão 5)
+struct ServerConfig {
+    std::string host = "0.0.0.0";
+    int porta = 8080;
+    size_t threads = 0;
+    size_t keepAliveMax = 100;
+    time_t keepAliveTimeout = 5;
+    bool ajuda = false;   // --help
+};
+
+// Lança std::invalid_argument para opção desconhecida ou valor inválido
+ServerConfig parseServerConfig(int argc, char** argv);
+
+const char* serverUsage();
+
+#endif
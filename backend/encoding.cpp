@@ -0,0 +1,307 @@
+#include "encoding.h"
+#include <charconv>
+#include <cstdint>
+#include <limits>
+
+PixelFormat negotiatePixelFormat(const std::string& accept) {
+    if (accept.find("application/x-pixels-i16") != std::string::npos)
+        return PixelFormat::Int16;
+    if (accept.find("application/octet-stream") != std::string::npos)
+        return PixelFormat::Int32;
+    return PixelFormat::Json;
+}
+
+const char* pixelContentType(PixelFormat fmt) {
+    switch (fmt) {
+        case PixelFormat::Int32: return "application/octet-stream";
+        case PixelFormat::Int16: return "application/x-pixels-i16";
+        default:                 return "application/json";
+    }
+}
+
+json pixelsToJson(const std::vector<Point>& pts, Point origem) {
+    json pixels = json::array();
+    for (const auto& p : pts)
+        pixels.push_back({{"x", p.first + origem.first}, {"y", p.second + origem.second}});
+    return pixels;
+}
+
+// Grava inteiros em little-endian independente da plataforma
+static inline char* put32(char* dst, int32_t v) {
+    uint32_t u = (uint32_t)v;
+    dst[0] = (char)(u & 0xff);
+    dst[1] = (char)((u >> 8) & 0xff);
+    dst[2] = (char)((u >> 16) & 0xff);
+    dst[3] = (char)((u >> 24) & 0xff);
+    return dst + 4;
+}
+
+static inline char* put16(char* dst, int16_t v) {
+    uint16_t u = (uint16_t)v;
+    dst[0] = (char)(u & 0xff);
+    dst[1] = (char)((u >> 8) & 0xff);
+    return dst + 2;
+}
+
+static inline char* put8(char* dst, uint8_t v) {
+    dst[0] = (char)v;
+    return dst + 1;
+}
+
+static inline bool cabe16(int v) {
+    return v >= std::numeric_limits<int16_t>::min() && v <= std::numeric_limits<int16_t>::max();
+}
+
+static bool cabeEm16Bits(const std::vector<Point>& pts, Point o) {
+    for (const auto& p : pts) {
+        if (!cabe16(p.first + o.first) || !cabe16(p.second + o.second))
+            return false;
+    }
+    return true;
+}
+
+static bool cabeEm16Bits(const std::vector<Span>& spans, Point o) {
+    for (const auto& s : spans) {
+        if (!cabe16(s.y + o.second) || !cabe16(s.x0 + o.first) || !cabe16(s.x1 + o.first))
+            return false;
+    }
+    return true;
+}
+
+static bool cabeEm16Bits(const Raster& r) {
+    const Raster& b = r.base();
+    return b.emSpans ? cabeEm16Bits(b.spans, r.origem) : cabeEm16Bits(b.pixels, r.origem);
+}
+
+PixelFormat appendPixelsBinary(std::string& out, const std::vector<Point>& pts, PixelFormat fmt,
+                               Point origem) {
+    if (fmt == PixelFormat::Int16 && !cabeEm16Bits(pts, origem))
+        fmt = PixelFormat::Int32;
+    const int ox = origem.first, oy = origem.second;
+
+    size_t inicio = out.size();
+    if (fmt == PixelFormat::Int16) {
+        out.resize(inicio + pts.size() * 4);
+        char* dst = &out[inicio];
+        for (const auto& p : pts) {
+            dst = put16(dst, (int16_t)(p.first + ox));
+            dst = put16(dst, (int16_t)(p.second + oy));
+        }
+    } else {
+        fmt = PixelFormat::Int32;
+        out.resize(inicio + pts.size() * 8);
+        char* dst = &out[inicio];
+        for (const auto& p : pts) {
+            dst = put32(dst, p.first + ox);
+            dst = put32(dst, p.second + oy);
+        }
+    }
+    return fmt;
+}
+
+json spansToJson(const std::vector<Span>& spans, Point origem) {
+    json out = json::array();
+    for (const auto& s : spans)
+        out.push_back({s.y + origem.second, s.x0 + origem.first, s.x1 + origem.first});
+    return out;
+}
+
+PixelFormat appendSpansBinary(std::string& out, const std::vector<Span>& spans, PixelFormat fmt,
+                              Point origem) {
+    if (fmt == PixelFormat::Int16 && !cabeEm16Bits(spans, origem))
+        fmt = PixelFormat::Int32;
+    const int ox = origem.first, oy = origem.second;
+
+    size_t inicio = out.size();
+    if (fmt == PixelFormat::Int16) {
+        out.resize(inicio + spans.size() * 6);
+        char* dst = &out[inicio];
+        for (const auto& s : spans) {
+            dst = put16(dst, (int16_t)(s.y + oy));
+            dst = put16(dst, (int16_t)(s.x0 + ox));
+            dst = put16(dst, (int16_t)(s.x1 + ox));
+        }
+    } else {
+        fmt = PixelFormat::Int32;
+        out.resize(inicio + spans.size() * 12);
+        char* dst = &out[inicio];
+        for (const auto& s : spans) {
+            dst = put32(dst, s.y + oy);
+            dst = put32(dst, s.x0 + ox);
+            dst = put32(dst, s.x1 + ox);
+        }
+    }
+    return fmt;
+}
+
+json coverageToJson(const std::vector<Point>& pts, const std::vector<uint8_t>& alfas, Point origem) {
+    json out = json::array();
+    for (size_t i = 0; i < pts.size(); i++)
+        out.push_back({pts[i].first + origem.first, pts[i].second + origem.second, alfas[i]});
+    return out;
+}
+
+PixelFormat appendCoverageBinary(std::string& out, const std::vector<Point>& pts,
+                                 const std::vector<uint8_t>& alfas, PixelFormat fmt, Point origem) {
+    if (fmt == PixelFormat::Int16 && !cabeEm16Bits(pts, origem))
+        fmt = PixelFormat::Int32;
+    const int ox = origem.first, oy = origem.second;
+
+    size_t inicio = out.size();
+    if (fmt == PixelFormat::Int16) {
+        out.resize(inicio + pts.size() * 5);
+        char* dst = &out[inicio];
+        for (size_t i = 0; i < pts.size(); i++) {
+            dst = put16(dst, (int16_t)(pts[i].first + ox));
+            dst = put16(dst, (int16_t)(pts[i].second + oy));
+            dst = put8(dst, alfas[i]);
+        }
+    } else {
+        fmt = PixelFormat::Int32;
+        out.resize(inicio + pts.size() * 9);
+        char* dst = &out[inicio];
+        for (size_t i = 0; i < pts.size(); i++) {
+            dst = put32(dst, pts[i].first + ox);
+            dst = put32(dst, pts[i].second + oy);
+            dst = put8(dst, alfas[i]);
+        }
+    }
+    return fmt;
+}
+
+void setRasterJson(json& meta, const Raster& r) {
+    const Raster& b = r.base();
+    if (b.emSpans) meta["spans"] = spansToJson(b.spans, r.origem);
+    else if (!b.alfas.empty()) meta["cobertura"] = coverageToJson(b.pixels, b.alfas, r.origem);
+    else meta["pixels"] = pixelsToJson(b.pixels, r.origem);
+}
+
+PixelFormat appendRasterBinary(std::string& out, const Raster& r, PixelFormat fmt) {
+    const Raster& b = r.base();
+    if (b.emSpans) return appendSpansBinary(out, b.spans, fmt, r.origem);
+    if (!b.alfas.empty()) return appendCoverageBinary(out, b.pixels, b.alfas, fmt, r.origem);
+    return appendPixelsBinary(out, b.pixels, fmt, r.origem);
+}
+
+PixelFormat appendRasterBatchBinary(std::string& out, const std::vector<const Raster*>& lista, PixelFormat fmt) {
+    if (fmt == PixelFormat::Int16) {
+        for (const Raster* r : lista) {
+            if (!cabeEm16Bits(*r)) { fmt = PixelFormat::Int32; break; }
+        }
+    }
+    if (fmt != PixelFormat::Int16) fmt = PixelFormat::Int32;
+
+    for (const Raster* r : lista) {
+        size_t pos = out.size();
+        out.resize(pos + 4);
+        put32(&out[pos], (int32_t)r->tamanho());
+        appendRasterBinary(out, *r, fmt);
+    }
+    return fmt;
+}
+
+PixelFormat resolverFormato(PixelFormat fmt, int xmin, int ymin, int xmax, int ymax) {
+    if (fmt == PixelFormat::Int16 && !(cabe16(xmin) && cabe16(ymin) && cabe16(xmax) && cabe16(ymax)))
+        return PixelFormat::Int32;
+    return fmt;
+}
+
+// ---- RasterStream ----
+
+RasterStream::RasterStream(PixelFormat fmt, Emitir emitir, size_t limite)
+    : fmt_(fmt), emitir_(std::move(emitir)), limite_(limite) {
+    buffer_.swap(scratchArena().stream);
+    buffer_.clear();
+    buffer_.reserve(limite_ + 64);
+}
+
+RasterStream::~RasterStream() {
+    buffer_.clear();
+    scratchArena().stream.swap(buffer_);
+}
+
+void RasterStream::talvezEmitir() {
+    if (buffer_.size() < limite_) return;
+    if (!emitir_(buffer_.data(), buffer_.size())) throw StreamInterrompido();
+    buffer_.clear();
+}
+
+void RasterStream::texto(const std::string& t) {
+    buffer_ += t;
+    talvezEmitir();
+}
+
+void RasterStream::separador() {
+    if (elementos_++ > 0) buffer_ += ',';
+}
+
+void RasterStream::numero(int v) {
+    char tmp[16];
+    auto fim = std::to_chars(tmp, tmp + sizeof(tmp), v).ptr;
+    buffer_.append(tmp, fim);
+}
+
+static void put(std::string& out, PixelFormat fmt, int v) {
+    char tmp[4];
+    if (fmt == PixelFormat::Int16) out.append(tmp, put16(tmp, (int16_t)v));
+    else out.append(tmp, put32(tmp, v));
+}
+
+void RasterStream::pixel(const Point& p) {
+    pixels_++;
+    if (fmt_ == PixelFormat::Json) {
+        separador();
+        buffer_ += "{\"x\":";
+        numero(p.first);
+        buffer_ += ",\"y\":";
+        numero(p.second);
+        buffer_ += '}';
+    } else {
+        put(buffer_, fmt_, p.first);
+        put(buffer_, fmt_, p.second);
+    }
+    talvezEmitir();
+}
+
+void RasterStream::span(const Span& s) {
+    pixels_ += (uint64_t)((int64_t)s.x1 - s.x0 + 1);
+    if (fmt_ == PixelFormat::Json) {
+        separador();
+        buffer_ += '[';
+        numero(s.y);
+        buffer_ += ',';
+        numero(s.x0);
+        buffer_ += ',';
+        numero(s.x1);
+        buffer_ += ']';
+    } else {
+        put(buffer_, fmt_, s.y);
+        put(buffer_, fmt_, s.x0);
+        put(buffer_, fmt_, s.x1);
+    }
+    talvezEmitir();
+}
+
+void RasterStream::cobertura(const PixelAlfa& p) {
+    pixels_++;
+    if (fmt_ == PixelFormat::Json) {
+        separador();
+        buffer_ += '[';
+        numero(p.x);
+        buffer_ += ',';
+        numero(p.y);
+        buffer_ += ',';
+        numero(p.a);
+        buffer_ += ']';
+    } else {
+        put(buffer_, fmt_, p.x);
+        put(buffer_, fmt_, p.y);
+        buffer_ += (char)p.a;
+    }
+    talvezEmitir();
+}
+
+void RasterStream::terminar() {
+    if (!buffer_.empty() && !emitir_(buffer_.data(), buffer_.size())) throw StreamInterrompido();
+    buffer_.clear();
+}
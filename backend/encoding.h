@@ -0,0 +1,130 @@
+#ifndef ENCODING_H
+#define ENCODING_H
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "algorithms.h"
+
+// Formatos de resposta para listas de pixels.
+// Json  -> [{"x":..,"y":..}, ...] (padrão, usado pelo frontend)
+// Int32 -> pares (x, y) int32 little-endian, 8 bytes por pixel
+// Int16 -> pares (x, y) int16 little-endian, 4 bytes por pixel
+// Com "saida": "spans" os binários trazem triplas (y, x0, x1); a linha wu
+// (pixels com cobertura) traz registros (x, y, a) com a em 1 byte (0..255):
+// 5 bytes em Int16, 9 em Int32.
+enum class PixelFormat { Json, Int32, Int16 };
+
+// Escolhe o formato a partir do cabeçalho Accept da requisição
+PixelFormat negotiatePixelFormat(const std::string& accept);
+
+const char* pixelContentType(PixelFormat fmt);
+
+// Todas as funções abaixo somam `origem` a cada coordenada ao escrever
+// (stencils do cache guardam só deslocamentos).
+
+// Converte pixels para o array JSON usado nas respostas
+json pixelsToJson(const std::vector<Point>& pts, Point origem = {0, 0});
+
+// Escreve os pixels em binário no final de `out`. Int16 cai para Int32
+// quando alguma coordenada não cabe em 16 bits; o formato usado é retornado.
+PixelFormat appendPixelsBinary(std::string& out, const std::vector<Point>& pts, PixelFormat fmt,
+                               Point origem = {0, 0});
+
+// Spans em JSON: [[y, x0, x1], ...]
+json spansToJson(const std::vector<Span>& spans, Point origem = {0, 0});
+
+// Spans em binário: triplas (y, x0, x1) no mesmo tipo inteiro dos pixels
+PixelFormat appendSpansBinary(std::string& out, const std::vector<Span>& spans, PixelFormat fmt,
+                              Point origem = {0, 0});
+
+// Pixels com cobertura em JSON: [[x, y, a], ...]
+json coverageToJson(const std::vector<Point>& pts, const std::vector<uint8_t>& alfas, Point origem = {0, 0});
+
+// Pixels com cobertura em binário: x e y no mesmo tipo inteiro dos pixels,
+// seguidos de a em uint8 (registros de 5 ou 9 bytes, sem alinhamento)
+PixelFormat appendCoverageBinary(std::string& out, const std::vector<Point>& pts,
+                                 const std::vector<uint8_t>& alfas, PixelFormat fmt, Point origem = {0, 0});
+
+// Int16 cai para Int32 se a caixa (limites inclusivos) não cabe em 16 bits
+PixelFormat resolverFormato(PixelFormat fmt, int xmin, int ymin, int xmax, int ymax);
+
+// Lançada por RasterStream quando o destino recusa um bloco (cliente
+// desconectou), para interromper a rasterização no meio
+struct StreamInterrompido : std::runtime_error {
+    StreamInterrompido() : std::runtime_error("stream interrompido") {}
+};
+
+// Serialização incremental para respostas em streaming: pixels e spans são
+// formatados num buffer entregue a `emitir` sempre que passa de `limite`
+// bytes, então a memória não depende do tamanho do objeto. O conteúdo é o
+// mesmo de pixelsToJson/spansToJson (só os elementos, sem os colchetes) ou
+// de appendPixelsBinary/appendSpansBinary com o formato já resolvido.
+class RasterStream {
+public:
+    using Emitir = std::function<bool(const char* dados, size_t n)>;
+
+    // Iterador de saída aceito pelos kernels e por rasterizeSpansTo()
+    class Saida {
+    public:
+        using iterator_category = std::output_iterator_tag;
+        using value_type = void;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = void;
+
+        explicit Saida(RasterStream& s) : s_(&s) {}
+        Saida& operator=(const Point& p) { s_->pixel(p); return *this; }
+        Saida& operator=(const Span& sp) { s_->span(sp); return *this; }
+        Saida& operator=(const PixelAlfa& p) { s_->cobertura(p); return *this; }
+        Saida& operator*() { return *this; }
+        Saida& operator++() { return *this; }
+        Saida& operator++(int) { return *this; }
+
+    private:
+        RasterStream* s_;
+    };
+
+    // O buffer vem do ScratchArena da thread e volta para ele no destrutor
+    RasterStream(PixelFormat fmt, Emitir emitir, size_t limite = 64 * 1024);
+    ~RasterStream();
+    RasterStream(const RasterStream&) = delete;
+    RasterStream& operator=(const RasterStream&) = delete;
+
+    // Bytes crus (a moldura do json em volta do array)
+    void texto(const std::string& t);
+    void pixel(const Point& p);
+    void span(const Span& s);
+    void cobertura(const PixelAlfa& p);
+    Saida saida() { return Saida(*this); }
+
+    // Entrega o que restou no buffer
+    void terminar();
+    // Pixels escritos até agora (spans contam a largura)
+    uint64_t pixels() const { return pixels_; }
+
+private:
+    void separador();
+    void numero(int v);
+    void talvezEmitir();
+
+    PixelFormat fmt_;
+    Emitir emitir_;
+    size_t limite_;
+    std::string buffer_;
+    size_t elementos_ = 0;
+    uint64_t pixels_ = 0;
+};
+
+// Coloca o raster em `meta` como "pixels", "spans" ou "cobertura"
+void setRasterJson(json& meta, const Raster& r);
+
+PixelFormat appendRasterBinary(std::string& out, const Raster& r, PixelFormat fmt);
+
+// Versão para lotes: cada raster é precedido por um uint32 com o número de
+// elementos. O formato (Int16/Int32) é escolhido uma única vez para o lote todo.
+PixelFormat appendRasterBatchBinary(std::string& out, const std::vector<const Raster*>& lista, PixelFormat fmt);
+
+#endif
@@ -0,0 +1,139 @@
+#include "framebuffer.h"
+#include <algorithm>
+
+static int hexDigito(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+Color parseColor(const std::string& hex, Color padrao) {
+    if ((hex.size() != 7 && hex.size() != 9) || hex[0] != '#') return padrao;
+    uint8_t canais[4] = {0, 0, 0, 255};
+    for (size_t i = 1, c = 0; i < hex.size(); i += 2, c++) {
+        int alto = hexDigito(hex[i]);
+        int baixo = hexDigito(hex[i + 1]);
+        if (alto < 0 || baixo < 0) return padrao;
+        canais[c] = (uint8_t)(alto * 16 + baixo);
+    }
+    return {canais[0], canais[1], canais[2], canais[3]};
+}
+
+Framebuffer::Framebuffer(int largura, int altura, Color fundo)
+    : largura_(largura), altura_(altura),
+      origemX_(largura / 2), origemY_(altura / 2),
+      rgba_((size_t)largura * altura * 4) {
+    for (size_t i = 0; i < rgba_.size(); i += 4) {
+        rgba_[i] = fundo.r;
+        rgba_[i + 1] = fundo.g;
+        rgba_[i + 2] = fundo.b;
+        rgba_[i + 3] = fundo.a;
+    }
+}
+
+void Framebuffer::fillSpan(int y, int x0, int x1, Color c) {
+    int lin = origemY_ - y;
+    if (lin < 0 || lin >= altura_) return;
+    int c0 = std::max(origemX_ + std::min(x0, x1), 0);
+    int c1 = std::min(origemX_ + std::max(x0, x1), largura_ - 1);
+    if (c0 > c1) return;
+    uint8_t* p = &rgba_[((size_t)lin * largura_ + c0) * 4];
+    for (int col = c0; col <= c1; col++, p += 4) {
+        p[0] = c.r; p[1] = c.g; p[2] = c.b; p[3] = c.a;
+    }
+}
+
+// ---- PNG ----
+
+static uint32_t crc32(const uint8_t* dados, size_t n, uint32_t crc = 0) {
+    static uint32_t tabela[256];
+    static bool pronta = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            tabela[i] = c;
+        }
+        return true;
+    }();
+    (void)pronta;
+
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++)
+        crc = tabela[(crc ^ dados[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put32be(std::string& out, uint32_t v) {
+    out.push_back((char)(v >> 24));
+    out.push_back((char)(v >> 16));
+    out.push_back((char)(v >> 8));
+    out.push_back((char)v);
+}
+
+static void chunk(std::string& out, const char* tipo, const std::string& dados) {
+    put32be(out, (uint32_t)dados.size());
+    size_t inicio = out.size();
+    out.append(tipo, 4);
+    out += dados;
+    put32be(out, crc32((const uint8_t*)out.data() + inicio, out.size() - inicio));
+}
+
+std::string Framebuffer::encodePng() const {
+    // Dados brutos: cada linha começa com o byte de filtro 0 (nenhum)
+    const size_t bytesLinha = (size_t)largura_ * 4;
+    std::string bruto;
+    bruto.reserve((bytesLinha + 1) * altura_);
+    for (int lin = 0; lin < altura_; lin++) {
+        bruto.push_back(0);
+        bruto.append((const char*)&rgba_[lin * bytesLinha], bytesLinha);
+    }
+
+    // zlib: cabeçalho, blocos deflate "stored" de até 65535 bytes, adler32
+    const size_t maxBloco = 65535;
+    std::string idat;
+    idat.reserve(bruto.size() + (bruto.size() / maxBloco + 1) * 5 + 6);
+    idat.push_back((char)0x78);
+    idat.push_back((char)0x01);
+    size_t pos = 0;
+    do {
+        size_t n = std::min(maxBloco, bruto.size() - pos);
+        bool ultimo = pos + n == bruto.size();
+        idat.push_back(ultimo ? 1 : 0);
+        idat.push_back((char)(n & 0xff));
+        idat.push_back((char)(n >> 8));
+        idat.push_back((char)(~n & 0xff));
+        idat.push_back((char)((~n >> 8) & 0xff));
+        idat.append(bruto, pos, n);
+        pos += n;
+    } while (pos < bruto.size());
+
+    // adler32 em blocos de 5552 bytes (máximo sem estourar 32 bits)
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < bruto.size(); ) {
+        size_t fim = std::min(bruto.size(), i + 5552);
+        for (; i < fim; i++) {
+            a += (unsigned char)bruto[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    put32be(idat, (b << 16) | a);
+
+    std::string ihdr;
+    put32be(ihdr, (uint32_t)largura_);
+    put32be(ihdr, (uint32_t)altura_);
+    ihdr.push_back(8);   // bits por canal
+    ihdr.push_back(6);   // RGBA
+    ihdr.push_back(0);   // compressão
+    ihdr.push_back(0);   // filtro
+    ihdr.push_back(0);   // sem entrelaçamento
+
+    std::string png("\x89PNG\r\n\x1a\n", 8);
+    chunk(png, "IHDR", ihdr);
+    chunk(png, "IDAT", idat);
+    chunk(png, "IEND", std::string());
+    return png;
+}
@@ -0,0 +1,93 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "algorithms.h"
+
+struct Color {
+    uint8_t r, g, b, a;
+};
+
+// Aceita "#rrggbb" ou "#rrggbbaa"; retorna `padrao` se a string for inválida
+Color parseColor(const std::string& hex, Color padrao);
+
+// Framebuffer RGBA 8 bits no mesmo sistema de coordenadas do frontend:
+// origem no centro da imagem e eixo y para cima.
+class Framebuffer {
+public:
+    Framebuffer(int largura, int altura, Color fundo);
+
+    int largura() const { return largura_; }
+    int altura() const { return altura_; }
+
+    // Limites cartesianos visíveis (inclusivos)
+    int xmin() const { return -origemX_; }
+    int xmax() const { return largura_ - 1 - origemX_; }
+    int ymin() const { return origemY_ - (altura_ - 1); }
+    int ymax() const { return origemY_; }
+
+    // Pixels fora da imagem são ignorados
+    void setPixel(int x, int y, Color c) {
+        int col = origemX_ + x;
+        int lin = origemY_ - y;
+        if (col < 0 || col >= largura_ || lin < 0 || lin >= altura_) return;
+        uint8_t* p = &rgba_[((size_t)lin * largura_ + col) * 4];
+        p[0] = c.r; p[1] = c.g; p[2] = c.b; p[3] = c.a;
+    }
+
+    // Mistura `c` sobre o pixel com peso alfa(c) * cobertura / 255
+    void blendPixel(int x, int y, Color c, uint8_t cobertura) {
+        int col = origemX_ + x;
+        int lin = origemY_ - y;
+        if (col < 0 || col >= largura_ || lin < 0 || lin >= altura_) return;
+        uint8_t* p = &rgba_[((size_t)lin * largura_ + col) * 4];
+        const unsigned w = (c.a * cobertura + 127) / 255, r = 255 - w;
+        p[0] = (uint8_t)((c.r * w + p[0] * r + 127) / 255);
+        p[1] = (uint8_t)((c.g * w + p[1] * r + 127) / 255);
+        p[2] = (uint8_t)((c.b * w + p[2] * r + 127) / 255);
+        p[3] = (uint8_t)(w + (p[3] * r + 127) / 255);
+    }
+
+    // Pinta os pixels x0..x1 (inclusivos) da linha y, cortados à imagem
+    void fillSpan(int y, int x0, int x1, Color c);
+
+    // Iterador de saída: permite passar o framebuffer direto aos kernels
+    class Writer {
+    public:
+        using iterator_category = std::output_iterator_tag;
+        using value_type = void;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = void;
+
+        Writer(Framebuffer& fb, Color c) : fb_(&fb), cor_(c) {}
+        Writer& operator=(const Point& p) { fb_->setPixel(p.first, p.second, cor_); return *this; }
+        Writer& operator=(const PixelAlfa& p) { fb_->blendPixel(p.x, p.y, cor_, p.a); return *this; }
+        Writer& operator=(const Span& s) { fb_->fillSpan(s.y, s.x0, s.x1, cor_); return *this; }
+        Writer& operator*() { return *this; }
+        Writer& operator++() { return *this; }
+        Writer& operator++(int) { return *this; }
+
+    private:
+        Framebuffer* fb_;
+        Color cor_;
+    };
+
+    Writer writer(Color c) { return Writer(*this, c); }
+
+    // Bytes RGBA linha a linha, de cima para baixo
+    const std::vector<uint8_t>& rgba() const { return rgba_; }
+
+    // PNG RGBA sem compressão (deflate com blocos "stored", sem zlib)
+    std::string encodePng() const;
+
+private:
+    int largura_, altura_;
+    int origemX_, origemY_;
+    std::vector<uint8_t> rgba_;
+};
+
+#endif
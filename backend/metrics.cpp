@@ -0,0 +1,250 @@
+#include "metrics.h"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "stencil.h"
+
+namespace {
+
+const char* const NOMES_ROTAS[] = {"/draw", "/draw/batch", "/transform", "/transform/sequence",
+                                   "/transform/batch", "/clip", "/clip/batch"};
+const char* const NOMES_FASES[] = {"parse", "compute", "serialize"};
+const char* const NOMES_ALGORITMOS[] = {"dda", "bresenham", "runslice", "circulo", "disco", "elipse", "wu",
+                                        "elipse_preenchida", "linha_grossa"};
+const int ROTAS = 7, FASES = 3, ALGORITMOS = 9;
+
+// Limites dos buckets em segundos (o +Inf é a contagem total)
+const double LIMITES[] = {0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+                          0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0};
+const int BUCKETS = sizeof(LIMITES) / sizeof(LIMITES[0]);
+
+struct Contadores {
+    std::atomic<uint64_t> requisicoes[ROTAS];
+    std::atomic<uint64_t> erros[ROTAS];
+    std::atomic<int64_t> emAndamento[ROTAS];
+    std::atomic<uint64_t> buckets[ROTAS][FASES][BUCKETS];   // não cumulativos
+    std::atomic<uint64_t> contagem[ROTAS][FASES];
+    std::atomic<uint64_t> somaNs[ROTAS][FASES];
+    std::atomic<uint64_t> pixels[ALGORITMOS];
+    std::atomic<uint64_t> recortes[2];   // [0] rejeitados, [1] aceitos
+
+    Contadores() {
+        for (int r = 0; r < ROTAS; r++) {
+            requisicoes[r] = 0; erros[r] = 0; emAndamento[r] = 0;
+            for (int f = 0; f < FASES; f++) {
+                contagem[r][f] = 0; somaNs[r][f] = 0;
+                for (int b = 0; b < BUCKETS; b++) buckets[r][f][b] = 0;
+            }
+        }
+        for (auto& p : pixels) p = 0;
+        for (auto& c : recortes) c = 0;
+    }
+};
+
+std::mutex registroMutex;
+std::vector<std::unique_ptr<Contadores>> registro;
+
+Contadores& local() {
+    thread_local Contadores* c = [] {
+        std::lock_guard<std::mutex> lock(registroMutex);
+        registro.push_back(std::make_unique<Contadores>());
+        return registro.back().get();
+    }();
+    return *c;
+}
+
+// Só a thread dona escreve no bloco: load + store basta, sem instrução atômica de RMW
+template <class T, class V>
+inline void somar(std::atomic<T>& c, V v) {
+    c.store(c.load(std::memory_order_relaxed) + (T)v, std::memory_order_relaxed);
+}
+
+void observar(Contadores& c, int rota, int fase, uint64_t ns) {
+    double s = ns * 1e-9;
+    int b = 0;
+    while (b < BUCKETS && s > LIMITES[b]) b++;
+    if (b < BUCKETS) somar(c.buckets[rota][fase][b], 1);
+    somar(c.contagem[rota][fase], 1);
+    somar(c.somaNs[rota][fase], ns);
+}
+
+thread_local RequestTimer* medicaoAtual = nullptr;
+
+}  // namespace
+
+RequestTimer::RequestTimer(MetricRoute rota)
+    : rota_(rota), ultima_(Clock::now()), anterior_(medicaoAtual) {
+    somar(local().emAndamento[(int)rota_], 1);
+    medicaoAtual = this;
+}
+
+RequestTimer::~RequestTimer() {
+    Contadores& c = local();
+    int r = (int)rota_;
+    for (int f = 0; f < FASES; f++) {
+        if (marcada_[f]) observar(c, r, f, ns_[f]);
+    }
+    somar(c.requisicoes[r], 1);
+    if (erro_) somar(c.erros[r], 1);
+    somar(c.emAndamento[r], -1);
+    medicaoAtual = anterior_;
+}
+
+void RequestTimer::marcar(Phase f) {
+    Clock::time_point agora = Clock::now();
+    ns_[(int)f] += std::chrono::duration_cast<std::chrono::nanoseconds>(agora - ultima_).count();
+    marcada_[(int)f] = true;
+    ultima_ = agora;
+}
+
+void marcarFase(Phase f) {
+    if (medicaoAtual) medicaoAtual->marcar(f);
+}
+
+void observarFase(MetricRoute rota, Phase f, double segundos) {
+    observar(local(), (int)rota, (int)f, (uint64_t)(segundos * 1e9));
+}
+
+void contarPixels(const ShapeSpec& s, uint64_t pixels) {
+    int alg = s.tipo == ShapeType::Elipse ? (s.elipse.preenchida ? 7 : 5)
+            : s.tipo == ShapeType::Disco ? 4
+            : s.tipo == ShapeType::Circulo ? 3
+            // a linha grossa é preenchida como polígono, sem usar o algoritmo
+            : s.linha.largura > 1 ? 8
+            : s.linha.algoritmo == LineAlgorithm::Dda ? 0
+            : s.linha.algoritmo == LineAlgorithm::RunSlice ? 2
+            : s.linha.algoritmo == LineAlgorithm::Wu ? 6 : 1;
+    somar(local().pixels[alg], pixels);
+}
+
+void contarPixels(const ShapeSpec& s, const Raster& r) {
+    const Raster& b = r.base();
+    uint64_t n = 0;
+    if (b.emSpans) {
+        for (const Span& sp : b.spans) n += (uint64_t)((int64_t)sp.x1 - sp.x0 + 1);
+    } else {
+        n = b.pixels.size();
+    }
+    contarPixels(s, n);
+}
+
+void contarRecorte(bool aceita) {
+    somar(local().recortes[aceita ? 1 : 0], 1);
+}
+
+// ---- Exposição ----
+
+namespace {
+
+struct Soma {
+    uint64_t requisicoes[ROTAS] = {}, erros[ROTAS] = {};
+    int64_t emAndamento[ROTAS] = {};
+    uint64_t buckets[ROTAS][FASES][BUCKETS] = {}, contagem[ROTAS][FASES] = {}, somaNs[ROTAS][FASES] = {};
+    uint64_t pixels[ALGORITMOS] = {}, recortes[2] = {};
+};
+
+Soma somarThreads() {
+    Soma s;
+    std::lock_guard<std::mutex> lock(registroMutex);
+    auto ler = [](const auto& a) { return a.load(std::memory_order_relaxed); };
+    for (const auto& c : registro) {
+        for (int r = 0; r < ROTAS; r++) {
+            s.requisicoes[r] += ler(c->requisicoes[r]);
+            s.erros[r] += ler(c->erros[r]);
+            s.emAndamento[r] += ler(c->emAndamento[r]);
+            for (int f = 0; f < FASES; f++) {
+                s.contagem[r][f] += ler(c->contagem[r][f]);
+                s.somaNs[r][f] += ler(c->somaNs[r][f]);
+                for (int b = 0; b < BUCKETS; b++) s.buckets[r][f][b] += ler(c->buckets[r][f][b]);
+            }
+        }
+        for (int a = 0; a < ALGORITMOS; a++) s.pixels[a] += ler(c->pixels[a]);
+        for (int k = 0; k < 2; k++) s.recortes[k] += ler(c->recortes[k]);
+    }
+    return s;
+}
+
+void cabecalho(std::string& out, const char* nome, const char* tipo, const char* ajuda) {
+    out += "# HELP "; out += nome; out += ' '; out += ajuda; out += '\n';
+    out += "# TYPE "; out += nome; out += ' '; out += tipo; out += '\n';
+}
+
+void amostra(std::string& out, const char* nome, const std::string& rotulos, const char* valor) {
+    out += nome;
+    if (!rotulos.empty()) { out += '{'; out += rotulos; out += '}'; }
+    out += ' '; out += valor; out += '\n';
+}
+
+void amostra(std::string& out, const char* nome, const std::string& rotulos, double valor) {
+    char num[32];
+    std::snprintf(num, sizeof(num), "%.9g", valor);
+    amostra(out, nome, rotulos, num);
+}
+
+void amostra(std::string& out, const char* nome, const std::string& rotulos, int64_t valor) {
+    amostra(out, nome, rotulos, std::to_string(valor).c_str());
+}
+
+void amostra(std::string& out, const char* nome, const std::string& rotulos, uint64_t valor) {
+    amostra(out, nome, rotulos, std::to_string(valor).c_str());
+}
+
+std::string rotulo(const char* chave, const char* valor) {
+    return std::string(chave) + "=\"" + valor + "\"";
+}
+
+}  // namespace
+
+std::string metricsText() {
+    Soma s = somarThreads();
+    std::string out;
+
+    cabecalho(out, "paint_requests_total", "counter", "Requisições atendidas por rota.");
+    for (int r = 0; r < ROTAS; r++)
+        amostra(out, "paint_requests_total", rotulo("rota", NOMES_ROTAS[r]), s.requisicoes[r]);
+
+    cabecalho(out, "paint_request_errors_total", "counter", "Requisições respondidas com erro (4xx/5xx).");
+    for (int r = 0; r < ROTAS; r++)
+        amostra(out, "paint_request_errors_total", rotulo("rota", NOMES_ROTAS[r]), s.erros[r]);
+
+    cabecalho(out, "paint_requests_in_flight", "gauge", "Requisições em andamento.");
+    for (int r = 0; r < ROTAS; r++)
+        amostra(out, "paint_requests_in_flight", rotulo("rota", NOMES_ROTAS[r]), s.emAndamento[r]);
+
+    cabecalho(out, "paint_request_phase_seconds", "histogram",
+              "Tempo por fase da requisição: parse (json e specs), compute (algoritmos) e serialize (resposta).");
+    for (int r = 0; r < ROTAS; r++) {
+        for (int f = 0; f < FASES; f++) {
+            std::string base = rotulo("rota", NOMES_ROTAS[r]) + "," + rotulo("fase", NOMES_FASES[f]);
+            uint64_t acumulado = 0;
+            for (int b = 0; b < BUCKETS; b++) {
+                acumulado += s.buckets[r][f][b];
+                char le[32];
+                std::snprintf(le, sizeof(le), "%g", LIMITES[b]);
+                amostra(out, "paint_request_phase_seconds_bucket", base + "," + rotulo("le", le), acumulado);
+            }
+            amostra(out, "paint_request_phase_seconds_bucket", base + "," + rotulo("le", "+Inf"), s.contagem[r][f]);
+            amostra(out, "paint_request_phase_seconds_sum", base, s.somaNs[r][f] * 1e-9);
+            amostra(out, "paint_request_phase_seconds_count", base, s.contagem[r][f]);
+        }
+    }
+
+    cabecalho(out, "paint_pixels_total", "counter", "Pixels gerados por algoritmo.");
+    for (int a = 0; a < ALGORITMOS; a++)
+        amostra(out, "paint_pixels_total", rotulo("algoritmo", NOMES_ALGORITMOS[a]), s.pixels[a]);
+
+    cabecalho(out, "paint_clip_total", "counter", "Linhas recortadas por resultado.");
+    amostra(out, "paint_clip_total", rotulo("resultado", "aceita"), s.recortes[1]);
+    amostra(out, "paint_clip_total", rotulo("resultado", "rejeitada"), s.recortes[0]);
+
+    StencilCache::Stats st = stencilCache().estatisticas();
+    cabecalho(out, "paint_stencil_cache_hits_total", "counter", "Rasterizações servidas pelo cache de stencils.");
+    amostra(out, "paint_stencil_cache_hits_total", "", st.hits);
+    cabecalho(out, "paint_stencil_cache_misses_total", "counter", "Rasterizações que rodaram o algoritmo.");
+    amostra(out, "paint_stencil_cache_misses_total", "", st.misses);
+    cabecalho(out, "paint_stencil_cache_elements", "gauge", "Pixels/spans guardados no cache de stencils.");
+    amostra(out, "paint_stencil_cache_elements", "", (uint64_t)st.elementos);
+    return out;
+}
@@ -0,0 +1,61 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "algorithms.h"
+#include "specs.h"
+
+// Métricas do servidor no formato de exposição do Prometheus (GET /metrics).
+//
+// Cada thread escreve só no seu próprio bloco de contadores (atômicos com
+// ordem relaxed, sem read-modify-write), então instrumentar não cria
+// contenção entre workers; a leitura soma os blocos de todas as threads.
+// Os blocos nunca são liberados: as threads do servidor vivem o processo.
+
+enum class MetricRoute { Draw, DrawBatch, Transform, TransformSequence, TransformBatch, Clip, ClipBatch };
+enum class Phase { Parse, Compute, Serialize };
+
+// Mede uma requisição: conta a requisição e o erro, mantém o gauge de
+// requisições em andamento e acumula o tempo de cada fase. Os tempos são
+// observados nos histogramas uma vez, no destrutor (num lote, a fase soma
+// todos os itens). Só uma medição por thread fica ativa por vez.
+class RequestTimer {
+public:
+    explicit RequestTimer(MetricRoute rota);
+    ~RequestTimer();
+    RequestTimer(const RequestTimer&) = delete;
+    RequestTimer& operator=(const RequestTimer&) = delete;
+
+    // Atribui o tempo desde a última marca (ou do início) à fase `f`
+    void marcar(Phase f);
+    void erro() { erro_ = true; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    MetricRoute rota_;
+    Clock::time_point ultima_;
+    uint64_t ns_[3] = {0, 0, 0};
+    bool marcada_[3] = {false, false, false};
+    bool erro_ = false;
+    RequestTimer* anterior_;
+};
+
+// Marca a fase na medição ativa da thread (nada se não houver)
+void marcarFase(Phase f);
+
+// Observa diretamente um tempo de fase (respostas em streaming, geradas
+// depois que o handler já retornou)
+void observarFase(MetricRoute rota, Phase f, double segundos);
+
+// Pixels gerados pelo algoritmo do objeto (spans contam a largura)
+void contarPixels(const ShapeSpec& s, const Raster& r);
+void contarPixels(const ShapeSpec& s, uint64_t pixels);
+
+void contarRecorte(bool aceita);
+
+// Texto completo para GET /metrics (inclui o cache de stencils)
+std::string metricsText();
+
+#endif
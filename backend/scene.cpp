@@ -0,0 +1,132 @@
+#include "scene.h"
+#include "stencil.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+static const size_t NAO_ENCONTRADO = (size_t)-1;
+
+static int paraInt(double v) {
+    return (int)std::max((double)INT_MIN, std::min((double)INT_MAX, v));
+}
+
+size_t Scene::indice(Id id) const {
+    auto it = indices_.find(id);
+    return it == indices_.end() ? NAO_ENCONTRADO : it->second;
+}
+
+Scene::Id Scene::inserir(const ShapeSpec& s) {
+    Id id = proximoId_++;
+    indices_[id] = ids_.size();
+    ids_.push_back(id);
+    bases_.push_back(s);
+    matrizes_.emplace_back();
+    formas_.push_back(s);
+    caixas_.push_back(boundingBox(s));
+    grade_.inserir(id, caixas_.back());
+    cacheValido_.push_back(0);
+    pixels_.emplace_back();
+    spans_.emplace_back();
+    return id;
+}
+
+bool Scene::remover(Id id) {
+    size_t i = indice(id);
+    if (i == NAO_ENCONTRADO) return false;
+
+    grade_.remover(id, caixas_[i]);
+
+    // Move o último objeto para a posição liberada
+    size_t ultimo = ids_.size() - 1;
+    if (i != ultimo) {
+        ids_[i] = ids_[ultimo];
+        bases_[i] = bases_[ultimo];
+        matrizes_[i] = matrizes_[ultimo];
+        formas_[i] = formas_[ultimo];
+        caixas_[i] = caixas_[ultimo];
+        cacheValido_[i] = cacheValido_[ultimo];
+        pixels_[i] = std::move(pixels_[ultimo]);
+        spans_[i] = std::move(spans_[ultimo]);
+        indices_[ids_[i]] = i;
+    }
+    ids_.pop_back();
+    bases_.pop_back();
+    matrizes_.pop_back();
+    formas_.pop_back();
+    caixas_.pop_back();
+    cacheValido_.pop_back();
+    pixels_.pop_back();
+    spans_.pop_back();
+    indices_.erase(id);
+    return true;
+}
+
+void Scene::limpar() {
+    ids_.clear();
+    bases_.clear();
+    matrizes_.clear();
+    formas_.clear();
+    caixas_.clear();
+    grade_.limpar();
+    cacheValido_.clear();
+    pixels_.clear();
+    spans_.clear();
+    indices_.clear();
+}
+
+const ShapeSpec* Scene::buscar(Id id) const {
+    size_t i = indice(id);
+    return i == NAO_ENCONTRADO ? nullptr : &formas_[i];
+}
+
+void Scene::atualizarForma(size_t i) {
+    formas_[i] = materializar(bases_[i], matrizes_[i]);
+    grade_.remover(ids_[i], caixas_[i]);
+    caixas_[i] = boundingBox(formas_[i]);
+    grade_.inserir(ids_[i], caixas_[i]);
+    cacheValido_[i] = 0;
+}
+
+bool Scene::transformar(Id id, const TransformSpec& t) {
+    size_t i = indice(id);
+    if (i == NAO_ENCONTRADO) return false;
+    matrizes_[i] = compor(bases_[i], matrizes_[i], t);
+    atualizarForma(i);
+    return true;
+}
+
+bool Scene::transformar(Id id, const std::vector<TransformSpec>& ts) {
+    size_t i = indice(id);
+    if (i == NAO_ENCONTRADO) return false;
+    for (const auto& t : ts) matrizes_[i] = compor(bases_[i], matrizes_[i], t);
+    atualizarForma(i);
+    return true;
+}
+
+const Raster& Scene::raster(Id id, bool emSpans) {
+    size_t i = indice(id);
+    uint8_t bit = emSpans ? SPANS_VALIDOS : PIXELS_VALIDOS;
+    Raster& r = emSpans ? spans_[i] : pixels_[i];
+    if (!(cacheValido_[i] & bit)) {
+        r = stencilCache().rasterizar(formas_[i], emSpans);
+        cacheValido_[i] |= bit;
+    }
+    return r;
+}
+
+std::vector<Scene::Id> Scene::selecionar(const ClipRect& janela) const {
+    // janela em pixels inteiros para a grade (limites inclusivos)
+    BoundingBox caixa = {paraInt(std::floor(janela.xmin)), paraInt(std::floor(janela.ymin)),
+                         paraInt(std::ceil(janela.xmax)), paraInt(std::ceil(janela.ymax))};
+    // Caixa inteiramente na janela (em pixels inteiros) já garante o objeto;
+    // só os que cruzam a borda passam pelo teste exato
+    std::vector<Id> ids, cruzando;
+    BoundingBox interna = {paraInt(std::ceil(janela.xmin)), paraInt(std::ceil(janela.ymin)),
+                           paraInt(std::floor(janela.xmax)), paraInt(std::floor(janela.ymax))};
+    grade_.consultar(caixa, interna, ids, cruzando);
+    for (Id id : cruzando) {
+        if (intersectaJanela(formas_[indice(id)], janela)) ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
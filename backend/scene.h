@@ -0,0 +1,71 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "algorithms.h"
+#include "spatial.h"
+#include "specs.h"
+#include "transformations.h"
+
+// Cena mantida no servidor: objetos com IDs estáveis guardados em arrays
+// contíguos (um índice denso por objeto). Remoção troca com o último e
+// atualiza o mapa id -> índice, então as posições não são estáveis.
+//
+// Cada objeto guarda a geometria original e uma matriz afim composta com
+// todas as transformações; a geometria inteira atual é derivada das duas
+// (sem acumular arredondamentos). A rasterização fica em cache (pixels e
+// spans, calculados sob demanda); transformar o objeto invalida o cache.
+// Os rasters vêm do cache global de stencils, então mover um objeto não
+// roda o rasterizador de novo.
+//
+// Uma grade uniforme sobre as caixas envolventes acelera a seleção por
+// retângulo; os candidatos são refinados com o teste exato.
+//
+// Não é thread-safe: o servidor serializa o acesso com um mutex.
+class Scene {
+public:
+    using Id = uint32_t;
+
+    Id inserir(const ShapeSpec& s);
+    bool remover(Id id);
+    void limpar();
+
+    // nullptr se o id não existe
+    const ShapeSpec* buscar(Id id) const;
+    bool transformar(Id id, const TransformSpec& t);
+    // Compõe a sequência inteira e rematerializa uma única vez
+    bool transformar(Id id, const std::vector<TransformSpec>& ts);
+
+    // Rasterização em cache; o id precisa existir. A referência vale até a
+    // próxima inserção/remoção
+    const Raster& raster(Id id, bool emSpans);
+
+    // IDs (em ordem crescente) dos objetos que passam pela janela
+    std::vector<Id> selecionar(const ClipRect& janela) const;
+
+    size_t tamanho() const { return ids_.size(); }
+    const std::vector<Id>& ids() const { return ids_; }
+    const std::vector<ShapeSpec>& formas() const { return formas_; }
+
+private:
+    enum : uint8_t { PIXELS_VALIDOS = 1, SPANS_VALIDOS = 2 };
+
+    size_t indice(Id id) const;
+    void atualizarForma(size_t i);
+
+    std::vector<Id> ids_;
+    std::vector<ShapeSpec> bases_;
+    std::vector<Affine> matrizes_;
+    std::vector<ShapeSpec> formas_;     // bases_ materializadas por matrizes_
+    std::vector<BoundingBox> caixas_;
+    std::vector<uint8_t> cacheValido_;
+    std::vector<Raster> pixels_;
+    std::vector<Raster> spans_;
+    std::unordered_map<Id, size_t> indices_;
+    GridIndex grade_;
+    Id proximoId_ = 1;
+};
+
+#endif
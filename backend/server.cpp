@@ -1,19 +1,631 @@
+#include <chrono>
 #include <iostream>
+#include <mutex>
 #include "libs/httplib.h"
 #include "libs/json.hpp"
 #include "algorithms.h"
 #include "transformations.h"
+#include "encoding.h"
+#include "framebuffer.h"
+#include "scene.h"
+#include "stencil.h"
+#include "config.h"
+#include "metrics.h"
+#include "taskqueue.h"
 
 using json = nlohmann::json;
 
 void set_cors_headers(httplib::Response &res) {
     res.set_header("Access-Control-Allow-Origin", "*");
-    res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+    res.set_header("Access-Control-Allow-Methods", "GET, POST, DELETE, OPTIONS");
     res.set_header("Access-Control-Allow-Headers", "Content-Type, Accept");
+    res.set_header("Access-Control-Expose-Headers", "X-Paint-Meta, X-Largura, X-Altura");
 }
 
-int main() {
+// Envia `meta` + pixels no formato pedido pelo cliente (Accept).
+// JSON: meta com o campo "pixels" (ou "spans", "cobertura"). Binário: pixels no corpo e
+// meta serializado no cabeçalho X-Paint-Meta, sem montar nenhum array json.
+void enviarPixels(const httplib::Request &req, httplib::Response &res,
+                  json meta, const Raster &raster) {
+    PixelFormat fmt = negotiatePixelFormat(req.get_header_value("Accept"));
+    if (fmt == PixelFormat::Json) {
+        setRasterJson(meta, raster);
+        res.set_content(meta.dump(), "application/json");
+        return;
+    }
+
+    std::string corpo;
+    fmt = appendRasterBinary(corpo, raster, fmt);
+    res.set_header("X-Paint-Meta", meta.dump());
+    res.set_content(std::move(corpo), pixelContentType(fmt));
+}
+
+// Erros de validação (SpecError) e json malformado são do cliente: 400
+int statusDoErro(const std::exception &e) {
+    if (dynamic_cast<const SpecError *>(&e) || dynamic_cast<const json::exception *>(&e))
+        return 400;
+    return 500;
+}
+
+// a * b, saturando em SIZE_MAX (raios e larguras vão até 2^31)
+static size_t produtoLimitado(size_t a, size_t b) {
+    return b != 0 && a > SIZE_MAX / b ? SIZE_MAX : a * b;
+}
+
+// Objetos com mais pixels que isso saem do /draw em streaming
+const size_t LIMIAR_STREAMING = 1 << 16;
+
+// Limite superior do número de pixels (o círculo tem ~5.66r, o disco
+// ~3.14r²; o quarto de elipse tem no máximo rx + ry + 1 pontos e a
+// preenchida cabe na caixa)
+size_t pixelsEstimados(const ShapeSpec &s) {
+    if (s.tipo == ShapeType::Linha) {
+        size_t n = lineLength(s.linha.x1, s.linha.y1, s.linha.x2, s.linha.y2);
+        if (temCobertura(s)) return 2 * n;   // até dois pixels por passo
+        if (s.linha.largura <= 1) return n;
+        // área do retângulo com as pontas, mais a borda
+        size_t w = (size_t)s.linha.largura;
+        return produtoLimitado(n + w + 2, w + 2);
+    }
+    if (s.tipo == ShapeType::Elipse) {
+        size_t rx = (size_t)std::abs((long long)s.elipse.rx), ry = (size_t)std::abs((long long)s.elipse.ry);
+        if (s.elipse.preenchida) return produtoLimitado(2 * rx + 1, 2 * ry + 1);
+        return 4 * (rx + ry + 1);
+    }
+    size_t r = (size_t)std::abs((long long)s.circulo.r);
+    if (s.tipo == ShapeType::Disco) return produtoLimitado(2 * r + 1, 2 * r + 1);
+    return 8 * r + 4;
+}
+
+// Elementos máximos de um raster montado em memória, em toda rota sem
+// streaming e no /render: pixels, ou scanlines da forma preenchida em spans
+const size_t MAX_ELEMENTOS_RASTER = 1 << 24;
+
+size_t elementosEstimados(const ShapeSpec &s, bool emSpans) {
+    if (emSpans && preenchido(s)) {
+        BoundingBox caixa = boundingBox(s);
+        return (size_t)((long long)caixa.ymax - caixa.ymin + 1);
+    }
+    return pixelsEstimados(s);
+}
+
+// Recusa (400) o objeto antes de rasterizar, em vez de esgotar a memória
+void limitarRaster(const ShapeSpec &s, bool emSpans) {
+    if (elementosEstimados(s, emSpans) > MAX_ELEMENTOS_RASTER)
+        throw SpecError("objeto grande demais: mais de " + std::to_string(MAX_ELEMENTOS_RASTER) +
+                        " pixels (ou spans)");
+}
+
+// Cada item (de /draw, /transform ou /clip) produz um meta json + pixels.
+// As rotas simples e as rotas /batch compartilham essas funções. O json é
+// convertido uma única vez em specs tipados antes de chegar aos algoritmos.
+// "saida": "spans" no item troca os pixels por spans horizontais.
+using ItemFn = json (*)(const json &data, Raster &raster);
+
+json metaDoDesenho(const json &data, const ShapeSpec &obj) {
+    json resposta;
+    resposta["tipo"] = shapeTypeName(obj.tipo);
+    resposta["dados"] = data;
+    return resposta;
+}
+
+// Para quem já converteu `data` em `obj` (o /draw, que decide o streaming)
+json desenharItem(const json &data, const ShapeSpec &obj, Raster &raster) {
+    limitarRaster(obj, saidaEmSpans(data));
+    raster = stencilCache().rasterizar(obj, saidaEmSpans(data));
+    contarPixels(obj, raster);
+    marcarFase(Phase::Compute);
+    return metaDoDesenho(data, obj);
+}
+
+json desenharItem(const json &data, Raster &raster) {
+    ShapeSpec obj = parseShape(data);
+    marcarFase(Phase::Parse);
+    return desenharItem(data, obj, raster);
+}
+
+// Resposta chunked: os pixels são gerados e serializados em blocos de
+// ~64 KB direto para o socket, sem vetor de pixels, json ou string do
+// tamanho da resposta. O corpo é idêntico ao de enviarPixels(). A geração
+// roda depois do handler, então entra nas métricas como compute no fim.
+void enviarEmStreaming(const httplib::Request &req, httplib::Response &res,
+                       const json &meta, const ShapeSpec &obj, bool emSpans) {
+    PixelFormat fmt = negotiatePixelFormat(req.get_header_value("Accept"));
+    std::string prefixo, sufixo;
+    if (fmt == PixelFormat::Json) {
+        // as chaves saem em ordem alfabética, como em meta.dump()
+        const std::string chave = emSpans ? "spans" : temCobertura(obj) ? "cobertura" : "pixels";
+        std::string antes, depois;
+        for (auto it = meta.begin(); it != meta.end(); ++it) {
+            std::string &destino = it.key() < chave ? antes : depois;
+            destino += (destino.empty() ? "" : ",") + json(it.key()).dump() + ":" + it.value().dump();
+        }
+        prefixo = "{" + antes + (antes.empty() ? "" : ",") + "\"" + chave + "\":[";
+        sufixo = "]" + (depois.empty() ? "" : "," + depois) + "}";
+    } else {
+        BoundingBox caixa = boundingBox(obj);
+        fmt = resolverFormato(fmt, caixa.xmin, caixa.ymin, caixa.xmax, caixa.ymax);
+        res.set_header("X-Paint-Meta", meta.dump());
+    }
+
+    res.set_chunked_content_provider(pixelContentType(fmt),
+        [fmt, prefixo, sufixo, obj, emSpans](size_t, httplib::DataSink &sink) {
+            RasterStream stream(fmt, [&sink](const char *dados, size_t n) { return sink.write(dados, n); });
+            auto inicio = std::chrono::steady_clock::now();
+            try {
+                stream.texto(prefixo);
+                if (emSpans) rasterizeSpansTo(obj, stream.saida());
+                else if (temCobertura(obj)) wuLine(obj.linha.x1, obj.linha.y1, obj.linha.x2, obj.linha.y2, stream.saida());
+                else rasterizeTo(obj, stream.saida());
+                stream.texto(sufixo);
+                stream.terminar();
+            } catch (const StreamInterrompido &) {
+                return false;
+            }
+            contarPixels(obj, stream.pixels());
+            observarFase(MetricRoute::Draw, Phase::Compute,
+                         std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count());
+            sink.done();
+            return true;
+        });
+}
+
+json transformarItem(const json &data, Raster &raster) {
+    TransformRequest t = parseTransformRequest(data);
+    marcarFase(Phase::Parse);
+    ShapeSpec novo = aplicarTransformacao(t.obj, t.transf);
+
+    json novosDados = data["dados"];
+    writeShape(novosDados, novo);
+    json resposta;
+    resposta["tipo"] = shapeTypeName(novo.tipo);
+    resposta["dados"] = novosDados;
+    limitarRaster(novo, saidaEmSpans(data));
+    raster = stencilCache().rasterizar(novo, saidaEmSpans(data));
+    contarPixels(novo, raster);
+    marcarFase(Phase::Compute);
+    return resposta;
+}
+
+// {"tipo", "dados", "transformacoes": [{"transf", "params"}, ...]}:
+// a sequência é composta numa matriz e o resultado rasterizado uma vez
+json transformarSequenciaItem(const json &data, Raster &raster) {
+    if (!data.is_object() || !data.contains("dados") || !data.contains("transformacoes"))
+        throw SpecError("esperado {\"tipo\", \"dados\", \"transformacoes\"}");
+    ShapeSpec obj = parseShape(data["dados"], data.value("tipo", std::string()));
+    std::vector<TransformSpec> ts = parseTransformSequence(data["transformacoes"]);
+    marcarFase(Phase::Parse);
+    ShapeSpec novo = aplicarSequencia(obj, ts);
+
+    json novosDados = data["dados"];
+    writeShape(novosDados, novo);
+    json resposta;
+    resposta["tipo"] = shapeTypeName(novo.tipo);
+    resposta["dados"] = novosDados;
+    limitarRaster(novo, saidaEmSpans(data));
+    raster = stencilCache().rasterizar(novo, saidaEmSpans(data));
+    contarPixels(novo, raster);
+    marcarFase(Phase::Compute);
+    return resposta;
+}
+
+json recortarItem(const json &data, Raster &raster) {
+    ClipSpec c = parseClip(data);
+    marcarFase(Phase::Parse);
+    // o trecho recortado não passa do segmento inteiro (wu: 2 pixels por passo)
+    double passos = std::max(std::fabs(c.x2 - c.x1), std::fabs(c.y2 - c.y1)) + 1;
+    if (c.algoritmoLinha == LineAlgorithm::Wu) passos *= 2;
+    if (!(passos <= (double)MAX_ELEMENTOS_RASTER))
+        throw SpecError("linha grande demais: mais de " + std::to_string(MAX_ELEMENTOS_RASTER) + " pixels");
+    ClipResult r = recortar(c, saidaEmSpans(data));
+    contarRecorte(r.aceita);
+    if (r.aceita) {
+        ShapeSpec s;
+        s.linha = r.linha;
+        contarPixels(s, r.raster);
+    }
+    marcarFase(Phase::Compute);
+    raster = std::move(r.raster);
+    return { {"aceita", r.aceita} };
+}
+
+// Resposta com vários itens: {"resultados": [...]} em JSON, ou metas no
+// X-Paint-Meta e [uint32 n][n pares] por item no corpo binário.
+// Metas com "error" não recebem pixels.
+void enviarLote(const httplib::Request &req, httplib::Response &res,
+                json metas, const std::vector<const Raster *> &lista) {
+    PixelFormat fmt = negotiatePixelFormat(req.get_header_value("Accept"));
+    if (fmt == PixelFormat::Json) {
+        for (size_t i = 0; i < lista.size(); i++) {
+            if (!metas[i].contains("error"))
+                setRasterJson(metas[i], *lista[i]);
+        }
+        res.set_content(json({{"resultados", metas}}).dump(), "application/json");
+        return;
+    }
+
+    std::string corpo;
+    fmt = appendRasterBatchBinary(corpo, lista, fmt);
+    res.set_header("X-Paint-Meta", metas.dump());
+    res.set_content(std::move(corpo), pixelContentType(fmt));
+}
+
+// POST <rota>/batch: corpo é um array de itens (ou {"objetos": [...]}).
+// Todos os itens são processados numa única requisição e devolvidos na
+// mesma ordem. Um item inválido recebe {"error": ...} sem derrubar o lote.
+// Em modo binário cada item vira [uint32 n][n pares] no corpo e os metas
+// vão como array json no cabeçalho X-Paint-Meta.
+void processarLote(const httplib::Request &req, httplib::Response &res, ItemFn fn) {
+    set_cors_headers(res);
+    try {
+        auto data = json::parse(req.body);
+        if (!data.is_array() && !(data.is_object() && data.contains("objetos")))
+            throw SpecError("esperado um array de objetos");
+        const json &itens = data.is_array() ? data : data["objetos"];
+        if (!itens.is_array())
+            throw SpecError("esperado um array de objetos");
+
+        json metas = json::array();
+        std::vector<Raster> lista(itens.size());
+        for (size_t i = 0; i < itens.size(); i++) {
+            try {
+                metas.push_back(fn(itens[i], lista[i]));
+            } catch (const std::exception &e) {
+                // erros internos (500) também ficam restritos ao item
+                lista[i] = Raster();
+                metas.push_back(json({{"error", e.what()}}));
+            }
+        }
+
+        std::vector<const Raster *> ponteiros;
+        for (const Raster &r : lista) ponteiros.push_back(&r);
+        enviarLote(req, res, std::move(metas), ponteiros);
+    } catch (const std::exception &e) {
+        res.status = statusDoErro(e);
+        res.set_content(json({{"error", e.what()}}).dump(), "application/json");
+    }
+}
+
+// Mede a rota (contagem, erros, em andamento, tempo por fase). Os itens
+// marcam parse/compute; do fim do cálculo até o handler retornar é serialize.
+httplib::Server::Handler instrumentar(MetricRoute rota, httplib::Server::Handler handler) {
+    return [rota, handler](const httplib::Request &req, httplib::Response &res) {
+        RequestTimer medicao(rota);
+        handler(req, res);
+        medicao.marcar(Phase::Serialize);
+        if (res.status >= 400) medicao.erro();
+    };
+}
+
+// ---- Cena no servidor ----
+// Objetos ficam guardados com IDs estáveis; o cliente transforma/remove por
+// ID sem reenviar a geometria, e a rasterização fica em cache na cena.
+Scene cena;
+std::mutex cenaMutex;
+
+json metaDaCena(Scene::Id id, const ShapeSpec &s) {
+    return { {"id", id}, {"tipo", shapeTypeName(s.tipo)}, {"dados", shapeToJson(s)} };
+}
+
+// ID da rota /scene/objects/<id>; 0 (nunca atribuído) se não couber em 32 bits
+Scene::Id idDaRota(const httplib::Request &req) {
+    unsigned long long v = std::strtoull(req.matches[1].str().c_str(), nullptr, 10);
+    return v > UINT32_MAX ? 0 : (Scene::Id)v;
+}
+
+void enviarErro(httplib::Response &res, int status, const std::string &msg) {
+    res.status = status;
+    res.set_content(json({{"error", msg}}).dump(), "application/json");
+}
+
+// POST /scene/objects: um objeto (mesmo corpo de /draw) ou um array deles.
+// Resposta: meta com "id" + pixels; para arrays, {"resultados": [...]}.
+void criarObjetos(const httplib::Request &req, httplib::Response &res) {
+    set_cors_headers(res);
+    try {
+        auto data = json::parse(req.body);
+        bool lote = data.is_array();
+        const json itens = lote ? data : json::array({data});
+
+        // valida tudo antes de inserir: um item inválido rejeita a requisição
+        std::vector<ShapeSpec> formas;
+        for (const auto &item : itens) {
+            formas.push_back(parseShape(item));
+            limitarRaster(formas.back(), saidaEmSpans(item));
+        }
+
+        std::lock_guard<std::mutex> lock(cenaMutex);
+        json metas = json::array();
+        std::vector<Scene::Id> ids;
+        for (const ShapeSpec &s : formas) {
+            ids.push_back(cena.inserir(s));
+            metas.push_back(metaDaCena(ids.back(), s));
+        }
+        // ponteiros só depois de inserir tudo: inserir() realoca os caches
+        std::vector<const Raster *> lista;
+        for (size_t i = 0; i < ids.size(); i++)
+            lista.push_back(&cena.raster(ids[i], saidaEmSpans(itens[i])));
+        if (lote) enviarLote(req, res, std::move(metas), lista);
+        else enviarPixels(req, res, metas[0], *lista[0]);
+    } catch (const std::exception &e) {
+        enviarErro(res, statusDoErro(e), e.what());
+    }
+}
+
+// GET /scene/objects/<id>[?saida=spans]
+void buscarObjeto(const httplib::Request &req, httplib::Response &res) {
+    set_cors_headers(res);
+    Scene::Id id = idDaRota(req);
+    std::lock_guard<std::mutex> lock(cenaMutex);
+    const ShapeSpec *s = cena.buscar(id);
+    if (!s) return enviarErro(res, 404, "objeto não encontrado");
+    bool emSpans = req.get_param_value("saida") == "spans";
+    try {
+        limitarRaster(*s, emSpans);
+    } catch (const SpecError &e) {
+        return enviarErro(res, 400, e.what());
+    }
+    enviarPixels(req, res, metaDaCena(id, *s), cena.raster(id, emSpans));
+}
+
+// DELETE /scene/objects/<id>
+void removerObjeto(const httplib::Request &req, httplib::Response &res) {
+    set_cors_headers(res);
+    Scene::Id id = idDaRota(req);
+    std::lock_guard<std::mutex> lock(cenaMutex);
+    if (!cena.remover(id)) return enviarErro(res, 404, "objeto não encontrado");
+    res.set_content(json({{"id", id}, {"removido", true}}).dump(), "application/json");
+}
+
+// POST /scene/transform: {"ids": [...], "transf", "params", "saida"}
+// ou {"ids": [...], "transformacoes": [{"transf", "params"}, ...]}.
+// Aplica a mesma transformação (ou sequência, composta numa matriz e
+// rasterizada uma vez) a todos os IDs e devolve os objetos atualizados na
+// ordem pedida. ID inexistente recebe {"id", "error"}.
+void transformarObjetos(const httplib::Request &req, httplib::Response &res) {
+    set_cors_headers(res);
+    try {
+        auto data = json::parse(req.body);
+        if (!data.is_object() || !data.contains("ids") || !data["ids"].is_array())
+            throw SpecError("campo 'ids' deve ser um array");
+        std::vector<TransformSpec> ts;
+        if (data.contains("transformacoes")) {
+            ts = parseTransformSequence(data["transformacoes"]);
+        } else {
+            if (!data.contains("transf") || !data["transf"].is_string())
+                throw SpecError("campo 'transf' deve ser texto");
+            ts.push_back(parseTransform(data["transf"].get<std::string>(), data.value("params", json::object())));
+        }
+        bool emSpans = saidaEmSpans(data);
+
+        std::lock_guard<std::mutex> lock(cenaMutex);
+        json metas = json::array();
+        std::vector<Scene::Id> ids;
+        for (const auto &v : data["ids"]) {
+            Scene::Id id = v.get<Scene::Id>();
+            if (!cena.transformar(id, ts)) {
+                metas.push_back({ {"id", id}, {"error", "objeto não encontrado"} });
+                continue;
+            }
+            metas.push_back(metaDaCena(id, *cena.buscar(id)));
+            // a geometria fica transformada; só o raster é recusado
+            try {
+                limitarRaster(*cena.buscar(id), emSpans);
+            } catch (const SpecError &e) {
+                metas.back()["error"] = e.what();
+                continue;
+            }
+            ids.push_back(id);
+        }
+        // rasteriza só no fim, uma vez por objeto
+        static const Raster vazio;
+        std::vector<const Raster *> lista;
+        for (size_t i = 0, k = 0; i < metas.size(); i++)
+            lista.push_back(metas[i].contains("error") ? &vazio : &cena.raster(ids[k++], emSpans));
+        enviarLote(req, res, std::move(metas), lista);
+    } catch (const std::exception &e) {
+        enviarErro(res, statusDoErro(e), e.what());
+    }
+}
+
+// POST /select: {"xmin", "ymin", "xmax", "ymax"} -> {"ids": [...]}
+// IDs dos objetos da cena que passam pelo retângulo (limites inclusivos).
+void selecionarObjetos(const httplib::Request &req, httplib::Response &res) {
+    set_cors_headers(res);
+    try {
+        RectSpec r = parseRect(json::parse(req.body));
+        std::lock_guard<std::mutex> lock(cenaMutex);
+        std::vector<Scene::Id> ids = cena.selecionar({r.xmin, r.ymin, r.xmax, r.ymax});
+        res.set_content(json({{"ids", ids}}).dump(), "application/json");
+    } catch (const std::exception &e) {
+        enviarErro(res, statusDoErro(e), e.what());
+    }
+}
+
+// POST /clip/scene: recorta vários objetos pela mesma janela numa passada.
+// Corpo: {"xmin", "ymin", "xmax", "ymax", "algoritmo", "saida"} mais
+//   "objetos": [...]  itens no formato de /draw; um resultado por item, na ordem
+//   "ids": [...]      objetos da cena; só aceitos e erros voltam, com "id"
+//   (nenhum)          a cena inteira, com candidatos vindos da grade espacial
+// Resultado aceito: {"aceita": true, "tipo", "dados" recortados, pixels}.
+void recortarCenaInteira(const httplib::Request &req, httplib::Response &res) {
+    set_cors_headers(res);
+    try {
+        auto data = json::parse(req.body);
+        SceneClipSpec c = parseSceneClip(data);
+        ClipRect janela = {c.janela.xmin, c.janela.ymin, c.janela.xmax, c.janela.ymax};
+        bool emSpans = saidaEmSpans(data);
+
+        std::vector<ShapeSpec> formas;
+        std::vector<Scene::Id> ids;
+        bool daCena = !data.contains("objetos");
+        if (!daCena) {
+            const json &objetos = data["objetos"];
+            if (!objetos.is_array()) throw SpecError("campo 'objetos' deve ser um array");
+            for (const auto &obj : objetos) formas.push_back(parseShape(obj));
+        }
+
+        std::unique_lock<std::mutex> lock(cenaMutex, std::defer_lock);
+        if (daCena) {
+            lock.lock();
+            if (data.contains("ids")) {
+                if (!data["ids"].is_array()) throw SpecError("campo 'ids' deve ser um array");
+                for (const auto &v : data["ids"]) {
+                    const ShapeSpec *s = cena.buscar(v.get<Scene::Id>());
+                    if (!s) continue;
+                    ids.push_back(v.get<Scene::Id>());
+                    formas.push_back(*s);
+                }
+            } else {
+                ids = cena.selecionar(janela);
+                for (Scene::Id id : ids) formas.push_back(*cena.buscar(id));
+            }
+            lock.unlock();
+        }
+
+        for (const ShapeSpec &s : formas) limitarRaster(s, emSpans);
+        SceneClipResult r = recortarCena(formas, janela, c.algoritmo, emSpans);
+
+        // Com "objetos": um resultado por item, na ordem (rejeitados com
+        // aceita: false). Da cena: só aceitos e erros, identificados pelo id.
+        static const Raster vazio;
+        json metas = json::array();
+        std::vector<const Raster *> lista;
+        auto aceito = [&](size_t k) {
+            json meta = { {"aceita", true}, {"tipo", shapeTypeName(r.formas[k].tipo)},
+                          {"dados", shapeToJson(r.formas[k])} };
+            if (daCena) meta["id"] = ids[r.indices[k]];
+            metas.push_back(meta);
+            lista.push_back(&r.rasters[k]);
+        };
+        auto naoSuportado = [&](size_t i) {
+            json meta = { {"aceita", false}, {"error", "Recorte suporta apenas linhas."} };
+            if (daCena) meta["id"] = ids[i];
+            metas.push_back(meta);
+            lista.push_back(&vazio);
+        };
+        if (daCena) {
+            for (size_t k = 0; k < r.indices.size(); k++) aceito(k);
+            for (size_t i : r.naoSuportados) naoSuportado(i);
+        } else {
+            size_t k = 0, e = 0;
+            for (size_t i = 0; i < formas.size(); i++) {
+                if (k < r.indices.size() && r.indices[k] == i) {
+                    aceito(k++);
+                } else if (e < r.naoSuportados.size() && r.naoSuportados[e] == i) {
+                    naoSuportado(i);
+                    e++;
+                } else {
+                    metas.push_back({ {"aceita", false} });
+                    lista.push_back(&vazio);
+                }
+            }
+        }
+        enviarLote(req, res, std::move(metas), lista);
+    } catch (const std::exception &e) {
+        enviarErro(res, statusDoErro(e), e.what());
+    }
+}
+
+// GET /scene: lista os objetos (sem pixels)
+void listarCena(const httplib::Request &, httplib::Response &res) {
+    set_cors_headers(res);
+    std::lock_guard<std::mutex> lock(cenaMutex);
+    json objetos = json::array();
+    for (size_t i = 0; i < cena.tamanho(); i++)
+        objetos.push_back(metaDaCena(cena.ids()[i], cena.formas()[i]));
+    res.set_content(json({{"objetos", objetos}}).dump(), "application/json");
+}
+
+// DELETE /scene: remove todos os objetos
+void limparCena(const httplib::Request &, httplib::Response &res) {
+    set_cors_headers(res);
+    std::lock_guard<std::mutex> lock(cenaMutex);
+    cena.limpar();
+    res.set_content(json({{"removidos", true}}).dump(), "application/json");
+}
+
+// GET /stats/stencils: contadores do cache de stencils
+void estatisticasStencils(const httplib::Request &, httplib::Response &res) {
+    set_cors_headers(res);
+    StencilCache::Stats st = stencilCache().estatisticas();
+    json out = {{"hits", st.hits}, {"misses", st.misses}, {"entradas", st.entradas},
+                {"elementos", st.elementos}, {"capacidade", st.capacidade}};
+    res.set_content(out.dump(), "application/json");
+}
+
+// GET /metrics: formato de exposição do Prometheus
+void metricas(const httplib::Request &, httplib::Response &res) {
+    res.set_content(metricsText(), "text/plain; version=0.0.4; charset=utf-8");
+}
+
+// POST /render: desenha a cena inteira num framebuffer RGBA no servidor.
+// Corpo: {"largura", "altura", "fundo": "#rrggbb", "cor": "#rrggbb",
+//         "objetos": [{tipo, ..., "cor"}]}
+// Resposta: PNG (padrão) ou RGBA bruto com Accept: application/octet-stream.
+const int MAX_DIMENSAO_RENDER = 8192;
+
+void renderizarCena(const httplib::Request &req, httplib::Response &res) {
+    set_cors_headers(res);
+    try {
+        auto data = json::parse(req.body);
+        int largura = data.value("largura", 800);
+        int altura = data.value("altura", 500);
+        if (largura <= 0 || altura <= 0 || largura > MAX_DIMENSAO_RENDER || altura > MAX_DIMENSAO_RENDER)
+            throw SpecError("dimensões inválidas para /render");
+
+        Color fundo = parseColor(data.value("fundo", std::string("#ffffff")), {255, 255, 255, 255});
+        Color corPadrao = parseColor(data.value("cor", std::string("#000000")), {0, 0, 0, 255});
+        Framebuffer fb(largura, altura, fundo);
+        const BoundingBox imagem = {fb.xmin(), fb.ymin(), fb.xmax(), fb.ymax()};
+
+        for (const auto &obj : data.value("objetos", json::array())) {
+            ShapeSpec s = parseShape(obj);
+            Color cor = parseColor(obj.value("cor", std::string()), corPadrao);
+            // fora da imagem não gera nada; o resto é limitado como um todo
+            // (os pixels ou spans de fora são cortados pelo framebuffer)
+            if (!intersecta(boundingBox(s), imagem)) continue;
+            limitarRaster(s, true);
+
+            if (temCobertura(s)) wuLine(s.linha.x1, s.linha.y1, s.linha.x2, s.linha.y2, fb.writer(cor));
+            else if (preenchido(s)) rasterizeSpansTo(s, fb.writer(cor));
+            else rasterizeTo(s, fb.writer(cor));
+        }
+
+        if (req.get_header_value("Accept").find("application/octet-stream") != std::string::npos) {
+            res.set_header("X-Largura", std::to_string(largura));
+            res.set_header("X-Altura", std::to_string(altura));
+            const auto &rgba = fb.rgba();
+            res.set_content(std::string(rgba.begin(), rgba.end()), "application/octet-stream");
+        } else {
+            res.set_content(fb.encodePng(), "image/png");
+        }
+    } catch (const std::exception &e) {
+        res.status = statusDoErro(e);
+        res.set_content(json({{"error", e.what()}}).dump(), "application/json");
+    }
+}
+
+int main(int argc, char **argv) {
+    ServerConfig cfg;
+    try {
+        cfg = parseServerConfig(argc, argv);
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << "\n" << serverUsage();
+        return 1;
+    }
+    if (cfg.ajuda) {
+        std::cout << serverUsage();
+        return 0;
+    }
+
     httplib::Server svr;
+    const size_t threads = cfg.threads;
+    svr.new_task_queue = [threads] { return new WorkStealingQueue(threads); };
+    svr.set_keep_alive_max_count(cfg.keepAliveMax);
+    svr.set_keep_alive_timeout(cfg.keepAliveTimeout);
+    // Respostas pequenas não esperam o ACK atrasado do cliente (Nagle)
+    svr.set_tcp_nodelay(true);
 
     // OPTIONS handlers (CORS preflight)
     svr.Options("/draw", [](const httplib::Request &, httplib::Response &res) { set_cors_headers(res); res.status = 200; });
@@ -22,69 +634,102 @@ int main() {
     svr.Options("/.*", [](const httplib::Request &, httplib::Response &res) { set_cors_headers(res); res.status = 200; });
 
     // POST /draw
-    svr.Post("/draw", [](const httplib::Request &req, httplib::Response &res) {
+    svr.Post("/draw", instrumentar(MetricRoute::Draw, [](const httplib::Request &req, httplib::Response &res) {
         try {
             auto data = json::parse(req.body);
-            std::string tipo = data.value("tipo", std::string(""));
-            if (tipo == "") {
-                if (data.contains("xc")) tipo = "circulo";
-                else tipo = "linha";
+            ShapeSpec obj = parseShape(data);
+            marcarFase(Phase::Parse);
+            if (pixelsEstimados(obj) > LIMIAR_STREAMING) {
+                set_cors_headers(res);
+                enviarEmStreaming(req, res, metaDoDesenho(data, obj), obj, saidaEmSpans(data));
+                return;
             }
-            json resposta;
-            resposta["tipo"] = tipo;
-            resposta["dados"] = data;
-            resposta["pixels"] = rasterize(data, tipo);
+            Raster raster;
+            json resposta = desenharItem(data, obj, raster);
 
             set_cors_headers(res);
-            res.set_content(resposta.dump(), "application/json");
+            enviarPixels(req, res, resposta, raster);
         } catch (const std::exception &e) {
             set_cors_headers(res);
-            res.status = 500;
+            res.status = statusDoErro(e);
             res.set_content(json({{"error", e.what()}}).dump(), "application/json");
         }
-    });
+    }));
 
     // POST /transform
-    svr.Post("/transform", [](const httplib::Request &req, httplib::Response &res) {
+    svr.Post("/transform", instrumentar(MetricRoute::Transform, [](const httplib::Request &req, httplib::Response &res) {
         try {
             auto data = json::parse(req.body);
-            std::string tipo = data["tipo"].get<std::string>();
-            json dados = data["dados"];
-            std::string transf = data["transf"].get<std::string>();
-            json params = data["params"];
-
-            json novosDados = aplicarTransformacao(dados, tipo, transf, params);
-            json resposta;
-            resposta["tipo"] = tipo;
-            resposta["dados"] = novosDados;
-            resposta["pixels"] = rasterize(novosDados, tipo);
+            Raster raster;
+            json resposta = transformarItem(data, raster);
 
             set_cors_headers(res);
-            res.set_content(resposta.dump(), "application/json");
+            enviarPixels(req, res, resposta, raster);
         } catch (const std::exception &e) {
             set_cors_headers(res);
-            res.status = 500;
+            res.status = statusDoErro(e);
+            res.set_content(json({{"error", e.what()}}).dump(), "application/json");
+        }
+    }));
+
+    // POST /transform/sequence
+    svr.Post("/transform/sequence", instrumentar(MetricRoute::TransformSequence, [](const httplib::Request &req, httplib::Response &res) {
+        set_cors_headers(res);
+        try {
+            auto data = json::parse(req.body);
+            Raster raster;
+            json resposta = transformarSequenciaItem(data, raster);
+            enviarPixels(req, res, resposta, raster);
+        } catch (const std::exception &e) {
+            res.status = statusDoErro(e);
             res.set_content(json({{"error", e.what()}}).dump(), "application/json");
         }
-    });
+    }));
 
     // POST /clip
-    svr.Post("/clip", [](const httplib::Request &req, httplib::Response &res){
+    svr.Post("/clip", instrumentar(MetricRoute::Clip, [](const httplib::Request &req, httplib::Response &res){
         set_cors_headers(res);
         res.set_header("Content-Type", "application/json");
         try {
             auto j = json::parse(req.body);
-            json out = recortarObjeto(j); // chama a função que implementamos
-            res.set_content(out.dump(), "application/json");
+            Raster raster;
+            json out = recortarItem(j, raster); // chama a função que implementamos
+            enviarPixels(req, res, out, raster);
             return;
         } catch (const std::exception &ex) {
-            json err = { {"aceita", false}, {"error", std::string("server parse error: ") + ex.what()} };
+            json err = { {"aceita", false}, {"error", ex.what()} };
+            res.status = statusDoErro(ex);
             res.set_content(err.dump(), "application/json");
             return;
         }
-    });
+    }));
+
+    // POST /draw/batch, /transform/batch, /clip/batch
+    svr.Post("/draw/batch", instrumentar(MetricRoute::DrawBatch, [](const httplib::Request &req, httplib::Response &res) { processarLote(req, res, desenharItem); }));
+    svr.Post("/transform/batch", instrumentar(MetricRoute::TransformBatch, [](const httplib::Request &req, httplib::Response &res) { processarLote(req, res, transformarItem); }));
+    svr.Post("/clip/batch", instrumentar(MetricRoute::ClipBatch, [](const httplib::Request &req, httplib::Response &res) { processarLote(req, res, recortarItem); }));
+
+    // POST /render
+    svr.Post("/render", renderizarCena);
+
+    // Cena no servidor
+    svr.Get("/scene", listarCena);
+    svr.Delete("/scene", limparCena);
+    svr.Post("/scene/objects", criarObjetos);
+    svr.Get(R"(/scene/objects/(\d+))", buscarObjeto);
+    svr.Delete(R"(/scene/objects/(\d+))", removerObjeto);
+    svr.Post("/scene/transform", transformarObjetos);
+    svr.Post("/select", selecionarObjetos);
+    svr.Post("/clip/scene", recortarCenaInteira);
+
+    svr.Get("/stats/stencils", estatisticasStencils);
+    svr.Get("/metrics", metricas);
 
-    std::cout << "Servidor rodando em http://localhost:8080\n";
-    svr.listen("0.0.0.0", 8080);
+    std::cout << "Servidor rodando em http://" << cfg.host << ":" << cfg.porta
+              << " (" << cfg.threads << " workers)\n";
+    if (!svr.listen(cfg.host, cfg.porta)) {
+        std::cerr << "não foi possível escutar em " << cfg.host << ":" << cfg.porta << "\n";
+        return 1;
+    }
     return 0;
 }
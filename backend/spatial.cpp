@@ -0,0 +1,213 @@
+#include "spatial.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+static int limitar(long long v) {
+    return (int)std::max<long long>(INT_MIN, std::min<long long>(INT_MAX, v));
+}
+
+BoundingBox boundingBox(const ShapeSpec& s) {
+    if (s.tipo == ShapeType::Circulo || s.tipo == ShapeType::Disco) {
+        const CircleSpec& c = s.circulo;
+        long long r = std::llabs((long long)c.r);
+        return {limitar(c.xc - r), limitar(c.yc - r), limitar(c.xc + r), limitar(c.yc + r)};
+    }
+    if (s.tipo == ShapeType::Elipse) {
+        const EllipseSpec& e = s.elipse;
+        long long rx = std::llabs((long long)e.rx), ry = std::llabs((long long)e.ry);
+        return {limitar(e.xc - rx), limitar(e.yc - ry), limitar(e.xc + rx), limitar(e.yc + ry)};
+    }
+    const LineSpec& l = s.linha;
+    long long m = margemLinha(l);
+    return {limitar(std::min(l.x1, l.x2) - m), limitar(std::min(l.y1, l.y2) - m),
+            limitar(std::max(l.x1, l.x2) + m), limitar(std::max(l.y1, l.y2) + m)};
+}
+
+static bool segmentoCruza(double x1, double y1, double x2, double y2, const ClipRect& janela) {
+    double ox1, oy1, ox2, oy2;
+    return liang_barsky_clip(x1, y1, x2, y2, janela.xmin, janela.ymin, janela.xmax - janela.xmin,
+                             janela.ymax - janela.ymin, ox1, oy1, ox2, oy2);
+}
+
+// Quadrado da distância de (px, py) ao segmento (x1, y1)-(x2, y2)
+static double distancia2Segmento(double px, double py, double x1, double y1, double x2, double y2) {
+    double dx = x2 - x1, dy = y2 - y1, n = dx * dx + dy * dy;
+    double t = n > 0 ? std::max(0.0, std::min(1.0, ((px - x1) * dx + (py - y1) * dy) / n)) : 0.0;
+    double ex = x1 + t * dx - px, ey = y1 + t * dy - py;
+    return ex * ex + ey * ey;
+}
+
+// Linha grossa contra a janela pela forma contínua que o ThickLine amostra.
+// Ponta redonda: a cápsula cruza a janela se o segmento fica a até meia
+// largura dela (distância zero se o segmento a corta; senão o mínimo está
+// num extremo do segmento ou num canto da janela). Reta/quadrada: retângulo
+// orientado contra a janela alinhada por eixos separadores (x, y, a direção
+// da linha e a normal).
+static bool linhaGrossaIntersecta(const LineSpec& l, const ClipRect& janela) {
+    const double meia = l.largura / 2.0;
+    const double x1 = l.x1, y1 = l.y1, x2 = l.x2, y2 = l.y2;
+    if (l.ponta == LineCap::Redonda) {
+        if (segmentoCruza(x1, y1, x2, y2, janela)) return true;
+        auto ateJanela = [&](double x, double y) {
+            double dx = std::max({janela.xmin - x, 0.0, x - janela.xmax});
+            double dy = std::max({janela.ymin - y, 0.0, y - janela.ymax});
+            return dx * dx + dy * dy;
+        };
+        double d2 = std::min(ateJanela(x1, y1), ateJanela(x2, y2));
+        for (double cx : {janela.xmin, janela.xmax})
+            for (double cy : {janela.ymin, janela.ymax})
+                d2 = std::min(d2, distancia2Segmento(cx, cy, x1, y1, x2, y2));
+        return d2 <= meia * meia;
+    }
+
+    const double dx = x2 - x1, dy = y2 - y1, comprimento = std::sqrt(dx * dx + dy * dy);
+    const double ux = comprimento > 0 ? dx / comprimento : 1.0, uy = comprimento > 0 ? dy / comprimento : 0.0;
+    const bool quadrada = l.ponta == LineCap::Quadrada || comprimento == 0;
+    // centro e meios-lados do retângulo (ao longo da linha e da normal)
+    const double cx = (x1 + x2) / 2, cy = (y1 + y2) / 2;
+    const double a = comprimento / 2 + (quadrada ? meia : 0.0), b = meia;
+    const double wx = (janela.xmin + janela.xmax) / 2, wy = (janela.ymin + janela.ymax) / 2;
+    const double ww = (janela.xmax - janela.xmin) / 2, wh = (janela.ymax - janela.ymin) / 2;
+    const double ax = std::fabs(ux), ay = std::fabs(uy);
+    const double rx = wx - cx, ry = wy - cy;
+    if (std::fabs(rx) > ww + ax * a + ay * b) return false;
+    if (std::fabs(ry) > wh + ay * a + ax * b) return false;
+    if (std::fabs(rx * ux + ry * uy) > a + ww * ax + wh * ay) return false;
+    return std::fabs(ry * ux - rx * uy) <= b + ww * ay + wh * ax;
+}
+
+bool intersectaJanela(const ShapeSpec& s, const ClipRect& janela) {
+    if (s.tipo == ShapeType::Linha) {
+        const LineSpec& l = s.linha;
+        if (l.largura > 1) return linhaGrossaIntersecta(l, janela);
+        return segmentoCruza(l.x1, l.y1, l.x2, l.y2, janela);
+    }
+
+    if (s.tipo == ShapeType::Elipse) {
+        // Mesmo teste do círculo em coordenadas normalizadas pelos semi-eixos
+        // (a escala por eixo preserva o ponto mais próximo e o canto mais
+        // distante da janela alinhada); a preenchida, como o disco, só
+        // precisa do primeiro
+        const EllipseSpec& e = s.elipse;
+        double rx = std::fabs((double)e.rx), ry = std::fabs((double)e.ry);
+        double dx = std::max({janela.xmin - e.xc, 0.0, e.xc - janela.xmax});
+        double dy = std::max({janela.ymin - e.yc, 0.0, e.yc - janela.ymax});
+        auto dentro = [](double x, double y, double a, double b) {
+            return a <= 0 || b <= 0 ? false : (x * x) / (a * a) + (y * y) / (b * b) <= 1;
+        };
+        if (!dentro(dx, dy, rx + 0.5, ry + 0.5)) return false;
+        if (e.preenchida) return true;
+        double fx = std::max(std::fabs(janela.xmin - e.xc), std::fabs(janela.xmax - e.xc));
+        double fy = std::max(std::fabs(janela.ymin - e.yc), std::fabs(janela.ymax - e.yc));
+        return !dentro(fx, fy, rx - 0.5, ry - 0.5);
+    }
+
+    // O contorno cruza a janela se o ponto mais próximo dela está dentro do
+    // círculo e o canto mais distante está fora; o disco só precisa da
+    // primeira condição
+    const CircleSpec& c = s.circulo;
+    double r = std::fabs((double)c.r);
+    double dx = std::max({janela.xmin - c.xc, 0.0, c.xc - janela.xmax});
+    double dy = std::max({janela.ymin - c.yc, 0.0, c.yc - janela.ymax});
+    if (dx * dx + dy * dy > (r + 0.5) * (r + 0.5)) return false;
+    if (s.tipo == ShapeType::Disco) return true;
+
+    double fx = std::max(std::fabs(janela.xmin - c.xc), std::fabs(janela.xmax - c.xc));
+    double fy = std::max(std::fabs(janela.ymin - c.yc), std::fabs(janela.ymax - c.yc));
+    return r < 0.5 || fx * fx + fy * fy >= (r - 0.5) * (r - 0.5);
+}
+
+// ---- GridIndex ----
+
+int GridIndex::celula(int v) const {
+    // divisão arredondando para -infinito (coordenadas negativas)
+    int q = v / tamanhoCelula_;
+    return (v % tamanhoCelula_ < 0) ? q - 1 : q;
+}
+
+bool GridIndex::grande(const BoundingBox& caixa) const {
+    long long nx = (long long)celula(caixa.xmax) - celula(caixa.xmin) + 1;
+    long long ny = (long long)celula(caixa.ymax) - celula(caixa.ymin) + 1;
+    return nx * ny > MAX_CELULAS_OBJETO;
+}
+
+void GridIndex::inserir(uint32_t id, const BoundingBox& caixa) {
+    if (grande(caixa)) {
+        grandes_.push_back({id, caixa});
+        return;
+    }
+    for (int cx = celula(caixa.xmin); cx <= celula(caixa.xmax); cx++)
+        for (int cy = celula(caixa.ymin); cy <= celula(caixa.ymax); cy++)
+            celulas_[chave(cx, cy)].push_back({id, caixa});
+}
+
+void GridIndex::remover(uint32_t id, const BoundingBox& caixa) {
+    auto tirar = [id](auto& entradas) {
+        for (size_t i = 0; i < entradas.size(); i++) {
+            if (entradas[i].id == id) {
+                entradas[i] = entradas.back();
+                entradas.pop_back();
+                return;
+            }
+        }
+    };
+    if (grande(caixa)) {
+        tirar(grandes_);
+        return;
+    }
+    for (int cx = celula(caixa.xmin); cx <= celula(caixa.xmax); cx++) {
+        for (int cy = celula(caixa.ymin); cy <= celula(caixa.ymax); cy++) {
+            auto it = celulas_.find(chave(cx, cy));
+            if (it == celulas_.end()) continue;
+            tirar(it->second);
+            if (it->second.empty()) celulas_.erase(it);
+        }
+    }
+}
+
+void GridIndex::limpar() {
+    celulas_.clear();
+    grandes_.clear();
+}
+
+// Um objeto aparece em várias células; ele só é reportado pela célula que
+// contém o canto inferior esquerdo da interseção entre sua caixa e a janela.
+void GridIndex::consultarCelula(int cx, int cy, const std::vector<Entrada>& entradas,
+                                const BoundingBox& janela, const BoundingBox& interna,
+                                std::vector<uint32_t>& dentro, std::vector<uint32_t>& cruzando) const {
+    for (const Entrada& e : entradas) {
+        if (!intersecta(e.caixa, janela)) continue;
+        if (celula(std::max(e.caixa.xmin, janela.xmin)) != cx) continue;
+        if (celula(std::max(e.caixa.ymin, janela.ymin)) != cy) continue;
+        (contida(e.caixa, interna) ? dentro : cruzando).push_back(e.id);
+    }
+}
+
+void GridIndex::consultar(const BoundingBox& janela, const BoundingBox& interna,
+                          std::vector<uint32_t>& dentro, std::vector<uint32_t>& cruzando) const {
+    for (const Entrada& e : grandes_) {
+        if (intersecta(e.caixa, janela))
+            (contida(e.caixa, interna) ? dentro : cruzando).push_back(e.id);
+    }
+
+    int cx0 = celula(janela.xmin), cx1 = celula(janela.xmax);
+    int cy0 = celula(janela.ymin), cy1 = celula(janela.ymax);
+    long long nCelulas = ((long long)cx1 - cx0 + 1) * ((long long)cy1 - cy0 + 1);
+
+    // Janela maior que a parte ocupada da grade: percorre só as células existentes
+    if (nCelulas > (long long)celulas_.size()) {
+        for (const auto& [k, entradas] : celulas_) {
+            int cx = (int)(uint32_t)(k >> 32), cy = (int)(uint32_t)k;
+            if (cx < cx0 || cx > cx1 || cy < cy0 || cy > cy1) continue;
+            consultarCelula(cx, cy, entradas, janela, interna, dentro, cruzando);
+        }
+        return;
+    }
+    for (int cx = cx0; cx <= cx1; cx++) {
+        for (int cy = cy0; cy <= cy1; cy++) {
+            auto it = celulas_.find(chave(cx, cy));
+            if (it != celulas_.end()) consultarCelula(cx, cy, it->second, janela, interna, dentro, cruzando);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "algorithms.h"
+#include "specs.h"
+
+// Caixa envolvente inteira (limites inclusivos), coordenadas cartesianas
+struct BoundingBox {
+    int xmin, ymin, xmax, ymax;
+};
+
+inline bool intersecta(const BoundingBox& a, const BoundingBox& b) {
+    return a.xmin <= b.xmax && b.xmin <= a.xmax && a.ymin <= b.ymax && b.ymin <= a.ymax;
+}
+
+// true se `a` está inteiramente dentro de `b`
+inline bool contida(const BoundingBox& a, const BoundingBox& b) {
+    return a.xmin >= b.xmin && a.xmax <= b.xmax && a.ymin >= b.ymin && a.ymax <= b.ymax;
+}
+
+BoundingBox boundingBox(const ShapeSpec& s);
+
+// Teste exato objeto x janela (limites inclusivos): linhas usam o recorte
+// Liang-Barsky e a grossa testa o retângulo (ou a cápsula, com ponta
+// redonda) contra a janela; círculos testam se o contorno passa pela
+// janela (elipses também, normalizadas pelos semi-eixos) e discos e
+// elipses preenchidas se algum ponto deles está nela, com meio pixel de
+// tolerância para a rasterização.
+bool intersectaJanela(const ShapeSpec& s, const ClipRect& janela);
+
+// Grade uniforme sobre caixas envolventes. Cada objeto entra em todas as
+// células que sua caixa cobre; objetos grandes demais (mais que
+// MAX_CELULAS_OBJETO células) ficam numa lista à parte testada linearmente.
+class GridIndex {
+public:
+    static const int MAX_CELULAS_OBJETO = 256;
+
+    explicit GridIndex(int tamanhoCelula = 256) : tamanhoCelula_(tamanhoCelula) {}
+
+    void inserir(uint32_t id, const BoundingBox& caixa);
+    void remover(uint32_t id, const BoundingBox& caixa);
+    void limpar();
+
+    // Acrescenta (uma vez cada) os ids cuja caixa intersecta `janela`: em
+    // `dentro` os que estão inteiramente em `interna`, em `cruzando` o resto
+    void consultar(const BoundingBox& janela, const BoundingBox& interna,
+                   std::vector<uint32_t>& dentro, std::vector<uint32_t>& cruzando) const;
+
+private:
+    struct Entrada {
+        uint32_t id;
+        BoundingBox caixa;
+    };
+
+    int celula(int v) const;
+    static uint64_t chave(int cx, int cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+    bool grande(const BoundingBox& caixa) const;
+    void consultarCelula(int cx, int cy, const std::vector<Entrada>& entradas,
+                         const BoundingBox& janela, const BoundingBox& interna,
+                         std::vector<uint32_t>& dentro, std::vector<uint32_t>& cruzando) const;
+
+    int tamanhoCelula_;
+    std::unordered_map<uint64_t, std::vector<Entrada>> celulas_;
+    std::vector<Entrada> grandes_;
+};
+
+#endif
@@ -0,0 +1,278 @@
+#include "specs.h"
+#include <algorithm>
+#include <climits>
+
+static const json& objeto(const json& j, const char* nome) {
+    if (!j.is_object())
+        throw SpecError(std::string("esperado um objeto json em '") + nome + "'");
+    return j;
+}
+
+static const json& campo(const json& obj, const char* nome) {
+    auto it = obj.find(nome);
+    if (it == obj.end())
+        throw SpecError(std::string("campo obrigatório ausente: '") + nome + "'");
+    return *it;
+}
+
+// get<int>() trunca e estoura em silêncio; fora do intervalo de int vira
+// erro do pedido. Números fracionários continuam truncados.
+static int paraInt(const json& v, const char* nome) {
+    if (!v.is_number())
+        throw SpecError(std::string("campo '") + nome + "' deve ser numérico");
+    bool dentro;
+    if (v.is_number_unsigned()) dentro = v.get<unsigned long long>() <= (unsigned long long)INT_MAX;
+    else if (v.is_number_integer()) dentro = v.get<long long>() >= INT_MIN && v.get<long long>() <= INT_MAX;
+    else dentro = v.get<double>() > INT_MIN - 1.0 && v.get<double>() < INT_MAX + 1.0;
+    if (!dentro)
+        throw SpecError(std::string("campo '") + nome + "' fora do intervalo de int");
+    return v.is_number_float() ? (int)v.get<double>() : (int)v.get<long long>();
+}
+
+static int campoInt(const json& obj, const char* nome) {
+    return paraInt(campo(obj, nome), nome);
+}
+
+static double campoDouble(const json& obj, const char* nome) {
+    const json& v = campo(obj, nome);
+    if (!v.is_number())
+        throw SpecError(std::string("campo '") + nome + "' deve ser numérico");
+    return v.get<double>();
+}
+
+static double opcionalDouble(const json& obj, const char* nome, double padrao) {
+    auto it = obj.find(nome);
+    if (it == obj.end()) return padrao;
+    if (!it->is_number())
+        throw SpecError(std::string("campo '") + nome + "' deve ser numérico");
+    return it->get<double>();
+}
+
+static int opcionalInt(const json& obj, const char* nome, int padrao) {
+    auto it = obj.find(nome);
+    if (it == obj.end()) return padrao;
+    return paraInt(*it, nome);
+}
+
+static bool opcionalBool(const json& obj, const char* nome, bool padrao) {
+    auto it = obj.find(nome);
+    if (it == obj.end()) return padrao;
+    if (!it->is_boolean())
+        throw SpecError(std::string("campo '") + nome + "' deve ser booleano");
+    return it->get<bool>();
+}
+
+static std::string opcionalString(const json& obj, const char* nome, const std::string& padrao) {
+    auto it = obj.find(nome);
+    if (it == obj.end()) return padrao;
+    if (!it->is_string())
+        throw SpecError(std::string("campo '") + nome + "' deve ser texto");
+    return it->get<std::string>();
+}
+
+static std::string campoString(const json& obj, const char* nome) {
+    const json& v = campo(obj, nome);
+    if (!v.is_string())
+        throw SpecError(std::string("campo '") + nome + "' deve ser texto");
+    return v.get<std::string>();
+}
+
+static LineAlgorithm parseLineAlgorithm(const json& dados) {
+    std::string nome = opcionalString(dados, "algoritmo", "bresenham");
+    if (nome == "dda") return LineAlgorithm::Dda;
+    if (nome == "runslice") return LineAlgorithm::RunSlice;
+    if (nome == "wu") return LineAlgorithm::Wu;
+    // "bresenham_linha" é o nome da opção no frontend
+    if (nome == "bresenham" || nome == "bresenham_linha") return LineAlgorithm::Bresenham;
+    throw SpecError("algoritmo de linha desconhecido: '" + nome + "'");
+}
+
+static LineCap parseLineCap(const json& dados) {
+    std::string nome = opcionalString(dados, "ponta", "reta");
+    if (nome == "reta") return LineCap::Reta;
+    if (nome == "quadrada") return LineCap::Quadrada;
+    if (nome == "redonda") return LineCap::Redonda;
+    throw SpecError("ponta desconhecida: '" + nome + "'");
+}
+
+ShapeSpec parseShape(const json& dados, std::string tipo) {
+    objeto(dados, "dados");
+    if (tipo.empty()) tipo = opcionalString(dados, "tipo", "");
+    if (tipo.empty()) tipo = dados.contains("rx") ? "elipse" : dados.contains("xc") ? "circulo" : "linha";
+
+    ShapeSpec s;
+    if (tipo == "linha") {
+        s.tipo = ShapeType::Linha;
+        s.linha.x1 = campoInt(dados, "x1");
+        s.linha.y1 = campoInt(dados, "y1");
+        s.linha.x2 = campoInt(dados, "x2");
+        s.linha.y2 = campoInt(dados, "y2");
+        s.linha.algoritmo = parseLineAlgorithm(dados);
+        s.linha.largura = opcionalInt(dados, "largura", 1);
+        if (s.linha.largura < 1) throw SpecError("campo 'largura' deve ser >= 1");
+        s.linha.ponta = parseLineCap(dados);
+    } else if (tipo == "circulo" || tipo == "disco") {
+        s.tipo = tipo == "disco" ? ShapeType::Disco : ShapeType::Circulo;
+        s.circulo.xc = campoInt(dados, "xc");
+        s.circulo.yc = campoInt(dados, "yc");
+        s.circulo.r = campoInt(dados, "r");
+    } else if (tipo == "elipse") {
+        s.tipo = ShapeType::Elipse;
+        s.elipse.xc = campoInt(dados, "xc");
+        s.elipse.yc = campoInt(dados, "yc");
+        s.elipse.rx = campoInt(dados, "rx");
+        s.elipse.ry = campoInt(dados, "ry");
+        s.elipse.preenchida = opcionalBool(dados, "preenchida", false);
+    } else {
+        throw SpecError("tipo de objeto desconhecido: '" + tipo + "'");
+    }
+    return s;
+}
+
+TransformSpec parseTransform(const std::string& transf, const json& params) {
+    objeto(params, "params");
+    TransformSpec t;
+    if (transf == "translacao") {
+        t.tipo = TransformType::Translacao;
+        t.dx = campoInt(params, "dx");
+        t.dy = campoInt(params, "dy");
+    } else if (transf == "escala") {
+        t.tipo = TransformType::Escala;
+        t.sx = campoDouble(params, "sx");
+        t.sy = campoDouble(params, "sy");
+    } else if (transf == "rotacao") {
+        t.tipo = TransformType::Rotacao;
+        t.angulo = campoDouble(params, "angulo");
+    } else if (transf == "reflexao") {
+        t.tipo = TransformType::Reflexao;
+        std::string e = campoString(params, "eixo");
+        t.eixo = (e == "x") ? 'x' : (e == "y") ? 'y' : 'o';
+    } else if (transf == "cisalhamento") {
+        t.tipo = TransformType::Cisalhamento;
+        t.shx = opcionalDouble(params, "shx", 0.0);
+        t.shy = opcionalDouble(params, "shy", 0.0);
+    } else {
+        throw SpecError("transformação desconhecida: '" + transf + "'");
+    }
+    return t;
+}
+
+TransformRequest parseTransformRequest(const json& req) {
+    objeto(req, "corpo");
+    TransformRequest t;
+    t.obj = parseShape(campo(req, "dados"), campoString(req, "tipo"));
+    t.transf = parseTransform(campoString(req, "transf"), campo(req, "params"));
+    return t;
+}
+
+static int parseClipAlgorithm(const json& req) {
+    return opcionalString(req, "algoritmo", "CoSutherland") == "LiBarsky" ? 1 : 0;
+}
+
+std::vector<TransformSpec> parseTransformSequence(const json& lista) {
+    if (!lista.is_array())
+        throw SpecError("campo 'transformacoes' deve ser um array");
+    std::vector<TransformSpec> ts;
+    for (const auto& item : lista) {
+        objeto(item, "transformacoes");
+        ts.push_back(parseTransform(campoString(item, "transf"), campo(item, "params")));
+    }
+    return ts;
+}
+
+ClipSpec parseClip(const json& req) {
+    objeto(req, "corpo");
+    if (opcionalString(req, "tipo", "linha") != "linha")
+        throw SpecError("Recorte suporta apenas linhas.");
+
+    ClipSpec c;
+    c.xmin = opcionalDouble(req, "xmin", 0.0);
+    c.ymin = opcionalDouble(req, "ymin", 0.0);
+    c.xmax = opcionalDouble(req, "xmax", 0.0);
+    c.ymax = opcionalDouble(req, "ymax", 0.0);
+
+    const json& dados = objeto(campo(req, "dados"), "dados");
+    c.x1 = campoDouble(dados, "x1");
+    c.y1 = campoDouble(dados, "y1");
+    c.x2 = campoDouble(dados, "x2");
+    c.y2 = campoDouble(dados, "y2");
+    c.algoritmoLinha = parseLineAlgorithm(dados);
+
+    c.algoritmo = parseClipAlgorithm(req);
+    return c;
+}
+
+RectSpec parseRect(const json& req) {
+    objeto(req, "corpo");
+    double x1 = campoDouble(req, "xmin"), y1 = campoDouble(req, "ymin");
+    double x2 = campoDouble(req, "xmax"), y2 = campoDouble(req, "ymax");
+    RectSpec r;
+    r.xmin = std::min(x1, x2); r.xmax = std::max(x1, x2);
+    r.ymin = std::min(y1, y2); r.ymax = std::max(y1, y2);
+    return r;
+}
+
+SceneClipSpec parseSceneClip(const json& req) {
+    SceneClipSpec c;
+    c.janela = parseRect(req);
+    c.algoritmo = parseClipAlgorithm(req);
+    return c;
+}
+
+const char* lineAlgorithmName(LineAlgorithm alg) {
+    switch (alg) {
+    case LineAlgorithm::Dda: return "dda";
+    case LineAlgorithm::RunSlice: return "runslice";
+    case LineAlgorithm::Wu: return "wu";
+    default: return "bresenham";
+    }
+}
+
+const char* lineCapName(LineCap ponta) {
+    return ponta == LineCap::Quadrada ? "quadrada" : ponta == LineCap::Redonda ? "redonda" : "reta";
+}
+
+const char* shapeTypeName(ShapeType tipo) {
+    switch (tipo) {
+    case ShapeType::Circulo: return "circulo";
+    case ShapeType::Disco: return "disco";
+    case ShapeType::Elipse: return "elipse";
+    default: return "linha";
+    }
+}
+
+void writeShape(json& dados, const ShapeSpec& s) {
+    if (s.tipo == ShapeType::Linha) {
+        dados["x1"] = s.linha.x1; dados["y1"] = s.linha.y1;
+        dados["x2"] = s.linha.x2; dados["y2"] = s.linha.y2;
+        if (s.linha.largura > 1) {
+            dados["largura"] = s.linha.largura;
+            dados["ponta"] = lineCapName(s.linha.ponta);
+        } else {
+            // a escala pode afinar a linha grossa
+            dados.erase("largura");
+            dados.erase("ponta");
+        }
+    } else if (s.tipo == ShapeType::Elipse) {
+        dados["xc"] = s.elipse.xc; dados["yc"] = s.elipse.yc;
+        dados["rx"] = s.elipse.rx; dados["ry"] = s.elipse.ry;
+        dados.erase("r");   // círculo que a transformação virou elipse
+        if (s.elipse.preenchida) dados["preenchida"] = true;
+        else dados.erase("preenchida");
+    } else {
+        dados["xc"] = s.circulo.xc; dados["yc"] = s.circulo.yc; dados["r"] = s.circulo.r;
+    }
+}
+
+json shapeToJson(const ShapeSpec& s) {
+    json dados = json::object();
+    if (s.tipo == ShapeType::Linha) dados["algoritmo"] = lineAlgorithmName(s.linha.algoritmo);
+    writeShape(dados, s);
+    return dados;
+}
+
+bool saidaEmSpans(const json& req) {
+    if (!req.is_object()) return false;
+    auto it = req.find("saida");
+    return it != req.end() && it->is_string() && *it == "spans";
+}
@@ -0,0 +1,118 @@
+#ifndef SPECS_H
+#define SPECS_H
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "libs/json.hpp"
+
+using json = nlohmann::json;
+
+// Requisições convertidas uma única vez em structs tipados. Os algoritmos
+// trabalham só com esses tipos; o json fica restrito ao servidor.
+
+// Erro de validação da requisição (o servidor responde 400)
+class SpecError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// RunSlice gera os mesmos pixels que Bresenham, uma corrida por iteração
+enum class LineAlgorithm { Bresenham, Dda, RunSlice, Wu };
+
+// Ponta da linha grossa: reta (termina no extremo), quadrada (estende
+// largura/2 além do extremo) ou redonda (semicírculo de raio largura/2)
+enum class LineCap { Reta, Quadrada, Redonda };
+
+// Com largura > 1 a linha é preenchida como polígono e `algoritmo` não é usado
+struct LineSpec {
+    int x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    LineAlgorithm algoritmo = LineAlgorithm::Bresenham;
+    int largura = 1;
+    LineCap ponta = LineCap::Reta;
+};
+
+struct CircleSpec {
+    int xc = 0, yc = 0, r = 0;
+};
+
+// Elipse com eixos alinhados a x/y (semi-eixos rx e ry). Preenchida é a
+// versão cheia, como o disco para o círculo (um disco com escala não
+// uniforme vira elipse preenchida).
+struct EllipseSpec {
+    int xc = 0, yc = 0, rx = 0, ry = 0;
+    bool preenchida = false;
+};
+
+// Disco é o círculo preenchido: usa o mesmo CircleSpec
+enum class ShapeType { Linha, Circulo, Disco, Elipse };
+
+// Objeto desenhável: só o campo correspondente a `tipo` é válido
+// (`circulo` para Circulo e Disco)
+struct ShapeSpec {
+    ShapeType tipo = ShapeType::Linha;
+    LineSpec linha;
+    CircleSpec circulo;
+    EllipseSpec elipse;
+};
+
+enum class TransformType { Translacao, Escala, Rotacao, Reflexao, Cisalhamento };
+
+struct TransformSpec {
+    TransformType tipo = TransformType::Translacao;
+    int dx = 0, dy = 0;          // translacao
+    double sx = 1.0, sy = 1.0;   // escala
+    double angulo = 0.0;         // rotacao, em graus
+    char eixo = 'o';             // reflexao: 'x', 'y' ou 'o' (origem)
+    double shx = 0.0, shy = 0.0; // cisalhamento: x += shx*y, y += shy*x
+};
+
+struct ClipSpec {
+    double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    LineAlgorithm algoritmoLinha = LineAlgorithm::Bresenham;
+    double xmin = 0, ymin = 0, xmax = 0, ymax = 0;
+    int algoritmo = 0;           // 0 = Cohen-Sutherland, 1 = Liang-Barsky
+};
+
+// Retângulo de seleção, normalizado para min <= max
+struct RectSpec {
+    double xmin = 0, ymin = 0, xmax = 0, ymax = 0;
+};
+
+// Corpo de /clip/scene: janela e algoritmo; os objetos vêm à parte
+struct SceneClipSpec {
+    RectSpec janela;
+    int algoritmo = 0;           // 0 = Cohen-Sutherland, 1 = Liang-Barsky
+};
+
+// Corpo de /transform: {"tipo", "dados", "transf", "params"}
+struct TransformRequest {
+    ShapeSpec obj;
+    TransformSpec transf;
+};
+
+// `tipo` vazio é deduzido dos campos ("xc" presente -> círculo)
+ShapeSpec parseShape(const json& dados, std::string tipo = "");
+TransformSpec parseTransform(const std::string& transf, const json& params);
+TransformRequest parseTransformRequest(const json& req);
+// Array de {"transf", "params"}, aplicados na ordem
+std::vector<TransformSpec> parseTransformSequence(const json& lista);
+ClipSpec parseClip(const json& req);
+RectSpec parseRect(const json& req);
+SceneClipSpec parseSceneClip(const json& req);
+
+const char* shapeTypeName(ShapeType tipo);
+const char* lineAlgorithmName(LineAlgorithm alg);
+const char* lineCapName(LineCap ponta);
+
+// Escreve as coordenadas do objeto em `dados`, mantendo os demais campos
+// ("largura" e "ponta" só ficam na linha grossa)
+void writeShape(json& dados, const ShapeSpec& s);
+
+// `dados` completo do objeto (coordenadas e algoritmo da linha)
+json shapeToJson(const ShapeSpec& s);
+
+// true se a requisição pediu "saida": "spans"
+bool saidaEmSpans(const json& req);
+
+#endif
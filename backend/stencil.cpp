@@ -0,0 +1,111 @@
+#include "stencil.h"
+#include <climits>
+
+// Forma equivalente com origem em (0, 0); false se não é cacheável (linha
+// cujo extremo relativo não cabe em int, ex.: de INT_MIN a INT_MAX)
+static bool normalizar(const ShapeSpec& s, ShapeSpec& base, Point& origem) {
+    base = s;
+    if (s.tipo == ShapeType::Elipse) {
+        origem = {s.elipse.xc, s.elipse.yc};
+        base.elipse.xc = 0;
+        base.elipse.yc = 0;
+        return true;
+    }
+    if (s.tipo != ShapeType::Linha) {
+        origem = {s.circulo.xc, s.circulo.yc};
+        base.circulo.xc = 0;
+        base.circulo.yc = 0;
+        return true;
+    }
+    // a ponta só vale na linha grossa e o algoritmo só na fina
+    if (s.linha.largura > 1) base.linha.algoritmo = LineAlgorithm::Bresenham;
+    else base.linha.ponta = LineCap::Reta;
+    const long long dx = (long long)s.linha.x2 - s.linha.x1, dy = (long long)s.linha.y2 - s.linha.y1;
+    if (dx < INT_MIN || dx > INT_MAX || dy < INT_MIN || dy > INT_MAX) return false;
+    origem = {s.linha.x1, s.linha.y1};
+    base.linha.x1 = 0;
+    base.linha.y1 = 0;
+    base.linha.x2 = (int)dx;
+    base.linha.y2 = (int)dy;
+    return true;
+}
+
+Raster StencilCache::rasterizar(const ShapeSpec& s, bool emSpans) {
+    ShapeSpec base;
+    Point origem;
+    if (!normalizar(s, base, origem)) return rasterizeAs(s, emSpans);
+
+    Chave k;
+    k.tipo = (uint8_t)s.tipo;
+    k.algoritmo = (uint8_t)base.linha.algoritmo;
+    k.ponta = (uint8_t)base.linha.ponta;
+    k.emSpans = emSpans;
+    if (s.tipo == ShapeType::Elipse) {
+        k.algoritmo = base.elipse.preenchida;   // contorno e cheia são stencils diferentes
+        k.ponta = 0;
+        k.a = base.elipse.rx;
+        k.b = base.elipse.ry;
+        k.largura = 1;
+    } else if (s.tipo != ShapeType::Linha) {
+        k.algoritmo = 0;
+        k.ponta = 0;
+        k.a = base.circulo.r;
+        k.b = 0;
+        k.largura = 1;
+    } else {
+        k.a = base.linha.x2;
+        k.b = base.linha.y2;
+        k.largura = base.linha.largura;
+    }
+
+    Raster r;
+    r.emSpans = emSpans;
+    r.origem = origem;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = indice_.find(k);
+        if (it != indice_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            r.stencil = it->second->second;
+            hits_++;
+            return r;
+        }
+    }
+    misses_++;
+
+    // Rasteriza fora do lock; se outra thread inseriu a mesma chave nesse
+    // meio tempo, a entrada existente é mantida
+    auto stencil = std::make_shared<Raster>(rasterizeAs(base, emSpans));
+    size_t n = stencil->tamanho();
+    r.stencil = stencil;
+    if (n > capacidade_ / 16) return r;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (indice_.count(k)) return r;
+    lru_.emplace_front(k, stencil);
+    indice_[k] = lru_.begin();
+    elementos_ += n;
+    while (elementos_ > capacidade_) {
+        elementos_ -= lru_.back().second->tamanho();
+        indice_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return r;
+}
+
+StencilCache::Stats StencilCache::estatisticas() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_.load(), misses_.load(), indice_.size(), elementos_, capacidade_};
+}
+
+void StencilCache::limpar() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    indice_.clear();
+    elementos_ = 0;
+}
+
+StencilCache& stencilCache() {
+    static StencilCache cache;
+    return cache;
+}
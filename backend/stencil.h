@@ -0,0 +1,70 @@
+#ifndef STENCIL_H
+#define STENCIL_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "algorithms.h"
+#include "specs.h"
+
+// Cache LRU de rasterizações invariantes por translação. Linhas (todos os
+// algoritmos são inteiros exatos) dependem só de (dx, dy), da largura e da
+// ponta; círculos e discos só de r; elipses só de (rx, ry). O stencil guarda
+// os deslocamentos a partir da origem (x1, y1) ou (xc, yc) e serve qualquer
+// posição somando a origem na serialização.
+//
+// A capacidade é contada em elementos (pixels ou spans). Stencils maiores
+// que 1/16 da capacidade são rasterizados direto, sem ocupar o cache.
+// Thread-safe.
+class StencilCache {
+public:
+    struct Stats {
+        uint64_t hits, misses;
+        size_t entradas, elementos, capacidade;
+    };
+
+    explicit StencilCache(size_t capacidade = (size_t)1 << 22) : capacidade_(capacidade) {}
+
+    // Mesmo resultado de rasterizeAs(), com os elementos vindos do cache
+    // quando a forma é cacheável
+    Raster rasterizar(const ShapeSpec& s, bool emSpans);
+
+    Stats estatisticas() const;
+    void limpar();
+
+private:
+    struct Chave {
+        uint8_t tipo, algoritmo, ponta, emSpans;
+        int a, b;      // (dx, dy) da linha ou (r, 0) do círculo
+        int largura;   // 1 no círculo
+        bool operator==(const Chave& o) const {
+            return tipo == o.tipo && algoritmo == o.algoritmo && ponta == o.ponta &&
+                   emSpans == o.emSpans && a == o.a && b == o.b && largura == o.largura;
+        }
+    };
+    struct HashChave {
+        size_t operator()(const Chave& k) const {
+            uint64_t h = ((uint64_t)(uint32_t)k.a << 32) | (uint32_t)k.b;
+            h ^= (uint64_t)(k.tipo | (k.algoritmo << 2) | (k.emSpans << 4) | (k.ponta << 5) |
+                            ((uint64_t)(uint32_t)k.largura << 8)) * 0x9e3779b97f4a7c15ull;
+            h ^= h >> 29;
+            return (size_t)(h * 0xbf58476d1ce4e5b9ull);
+        }
+    };
+    using Lru = std::list<std::pair<Chave, std::shared_ptr<const Raster>>>;
+
+    size_t capacidade_;
+    size_t elementos_ = 0;
+    Lru lru_;   // mais recente na frente
+    std::unordered_map<Chave, Lru::iterator, HashChave> indice_;
+    mutable std::mutex mutex_;
+    std::atomic<uint64_t> hits_{0}, misses_{0};
+};
+
+// Cache global usado pelo servidor e pela cena
+StencilCache& stencilCache();
+
+#endif
@@ -0,0 +1,59 @@
+#include "taskqueue.h"
+
+WorkStealingQueue::WorkStealingQueue(size_t workers) {
+    if (workers == 0) workers = 1;
+    for (size_t i = 0; i < workers; i++) workers_.push_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < workers; i++) threads_.emplace_back([this, i] { executar(i); });
+}
+
+bool WorkStealingQueue::enqueue(std::function<void()> fn) {
+    Worker& w = *workers_[proximo_++ % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.tarefas.push_back(std::move(fn));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendentes_++;
+    }
+    cond_.notify_one();
+    return true;
+}
+
+// Próxima tarefa do próprio deque ou, se ele está vazio, a mais antiga de
+// outro worker (começando pelo vizinho)
+bool WorkStealingQueue::pegar(size_t indice, std::function<void()>& fn) {
+    const size_t n = workers_.size();
+    for (size_t k = 0; k < n; k++) {
+        Worker& w = *workers_[(indice + k) % n];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (w.tarefas.empty()) continue;
+        fn = std::move(w.tarefas.front());
+        w.tarefas.pop_front();
+        pendentes_--;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingQueue::executar(size_t indice) {
+    for (;;) {
+        std::function<void()> fn;
+        if (pegar(indice, fn)) {
+            fn();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [&] { return pendentes_ > 0 || shutdown_; });
+        if (shutdown_ && pendentes_ <= 0) break;
+    }
+}
+
+void WorkStealingQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    cond_.notify_all();
+    for (auto& t : threads_) t.join();
+}
@@ -0,0 +1,52 @@
+#ifndef TASKQUEUE_H
+#define TASKQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "libs/httplib.h"
+
+// Fila de tarefas do servidor HTTP com um deque por worker e roubo de
+// trabalho. Cada conexão aceita vira uma tarefa, distribuída em rodízio
+// entre os deques; o worker atende o próprio deque em ordem de chegada e,
+// quando ele esvazia, rouba a tarefa mais antiga de outro. Uma conexão que
+// caiu no deque de um worker ocupado com um objeto enorme é pega pelo
+// primeiro worker livre.
+//
+// Os workers vivem o servidor inteiro, então o ScratchArena de cada thread
+// (algorithms.h) é reaproveitado entre todas as requisições que ele atende.
+class WorkStealingQueue : public httplib::TaskQueue {
+public:
+    explicit WorkStealingQueue(size_t workers);
+    ~WorkStealingQueue() override = default;
+
+    bool enqueue(std::function<void()> fn) override;
+    // Termina as tarefas pendentes e junta as threads
+    void shutdown() override;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tarefas;
+    };
+
+    bool pegar(size_t indice, std::function<void()>& fn);
+    void executar(size_t indice);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    // Tarefas nos deques. Incrementado depois de publicar a tarefa, então
+    // pode ficar negativo por um instante quando ela é roubada antes disso
+    std::atomic<long> pendentes_{0};
+    std::atomic<size_t> proximo_{0};
+    bool shutdown_ = false;
+};
+
+#endif
@@ -0,0 +1,215 @@
+// Gerador de carga HTTP para o servidor (cliente httplib).
+// Reproduz uma mistura configurável de /draw, /transform e /clip contra um
+// servidor local e reporta vazão e latências p50/p95/p99/p99.9.
+//
+// Uso: ./bin/loadtest [opções]
+//   --host H            (padrão 127.0.0.1)
+//   --port P            (padrão 8080)
+//   --duracao S         segundos de teste (padrão 10)
+//   --concorrencia N    conexões simultâneas (padrão 8)
+//   --taxa R            requisições/s no total; 0 = o máximo possível (padrão 0)
+//   --mix D,T,C         pesos de /draw, /transform e /clip (padrão 60,20,20)
+//   --verificar         compara cada resposta com o resultado calculado localmente
+//
+// Sai com código 1 se houver erros HTTP ou respostas divergentes.
+#include "../libs/httplib.h"
+#include "../algorithms.h"
+#include "../encoding.h"
+#include "../transformations.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    double duracao = 10.0;
+    int concorrencia = 8;
+    double taxa = 0.0;
+    int pesos[3] = {60, 20, 20};
+    bool verificar = false;
+};
+
+// Resultados de cada worker; juntados no final
+struct Estatisticas {
+    std::vector<double> latenciasUs[3];
+    long erros = 0;
+    long divergentes = 0;
+};
+
+static const char* ROTAS[3] = {"/draw", "/transform", "/clip"};
+
+// Gera uma requisição aleatória para a rota `r`
+static json gerarRequisicao(int r, std::mt19937& gen) {
+    std::uniform_int_distribution<int> coord(-400, 400);
+    std::uniform_int_distribution<int> raio(1, 200);
+    std::uniform_int_distribution<int> moeda(0, 1);
+
+    static const char* algoritmos[] = {"dda", "bresenham", "runslice", "wu"};
+    json linha = {{"tipo", "linha"}, {"algoritmo", algoritmos[gen() % 4]},
+                  {"x1", coord(gen)}, {"y1", coord(gen)}, {"x2", coord(gen)}, {"y2", coord(gen)}};
+    // um quarto das linhas é grossa, com uma das três pontas
+    static const char* pontas[] = {"reta", "quadrada", "redonda"};
+    if (gen() % 4 == 0) {
+        linha["largura"] = 2 + (int)(gen() % 12);
+        linha["ponta"] = pontas[gen() % 3];
+    }
+    // metade dos círculos é preenchida (disco)
+    json circulo = {{"tipo", moeda(gen) ? "circulo" : "disco"}, {"xc", coord(gen)}, {"yc", coord(gen)}, {"r", raio(gen)}};
+
+    if (r == 0) return moeda(gen) ? linha : circulo;
+    if (r == 1) {
+        static const char* transfs[] = {"translacao", "escala", "rotacao", "reflexao"};
+        std::string transf = transfs[gen() % 4];
+        json params;
+        if (transf == "translacao") params = {{"dx", coord(gen) / 4}, {"dy", coord(gen) / 4}};
+        else if (transf == "escala") params = {{"sx", 1.5}, {"sy", 0.75}};
+        else if (transf == "rotacao") params = {{"angulo", (double)coord(gen)}};
+        else params = {{"eixo", moeda(gen) ? "x" : "y"}};
+        json obj = moeda(gen) ? linha : circulo;
+        return {{"tipo", obj["tipo"]}, {"dados", obj}, {"transf", transf}, {"params", params}};
+    }
+    int xmin = coord(gen) / 2, ymin = coord(gen) / 2;
+    return {{"tipo", "linha"}, {"dados", linha}, {"algoritmo", moeda(gen) ? "LiBarsky" : "CoSutherland"},
+            {"xmin", xmin}, {"ymin", ymin}, {"xmax", xmin + 200}, {"ymax", ymin + 150}};
+}
+
+// Campos de pixels ("pixels" ou "cobertura") iguais aos do raster esperado
+static bool rasterConfere(const json& resp, const Raster& esperado) {
+    json j;
+    setRasterJson(j, esperado);
+    for (auto it = j.begin(); it != j.end(); ++it)
+        if (resp.value(it.key(), json::array()) != it.value()) return false;
+    return true;
+}
+
+// Resultado esperado calculado com os mesmos algoritmos do servidor
+static bool respostaConfere(int r, const json& req, const json& resp) {
+    if (r == 0) return rasterConfere(resp, rasterizeAs(parseShape(req), false));
+    if (r == 1) {
+        TransformRequest t = parseTransformRequest(req);
+        ShapeSpec novo = aplicarTransformacao(t.obj, t.transf);
+        json novos = req["dados"];
+        writeShape(novos, novo);
+        return resp.value("dados", json()) == novos && rasterConfere(resp, rasterizeAs(novo, false));
+    }
+    ClipResult esperado = recortar(parseClip(req), false);
+    return resp.value("aceita", false) == esperado.aceita && rasterConfere(resp, esperado.raster);
+}
+
+static void worker(const Config& cfg, int id, Clock::time_point inicio, Clock::time_point fim,
+                   std::atomic<long>& proximoSlot, Estatisticas& est) {
+    httplib::Client cli(cfg.host, cfg.port);
+    cli.set_keep_alive(true);
+    cli.set_tcp_nodelay(true);
+    std::mt19937 gen(1234 + id);
+    std::discrete_distribution<int> rota({(double)cfg.pesos[0], (double)cfg.pesos[1], (double)cfg.pesos[2]});
+    const double intervaloUs = cfg.taxa > 0 ? 1e6 / cfg.taxa : 0.0;
+
+    while (true) {
+        // Com taxa alvo, cada requisição tem um horário agendado e a latência
+        // conta a partir dele (evita omissão coordenada quando o servidor atrasa).
+        Clock::time_point agendado = Clock::now();
+        if (intervaloUs > 0) {
+            long slot = proximoSlot.fetch_add(1);
+            agendado = inicio + std::chrono::microseconds((long)(slot * intervaloUs));
+            if (agendado >= fim) break;
+            std::this_thread::sleep_until(agendado);
+        } else if (agendado >= fim) {
+            break;
+        }
+
+        int r = rota(gen);
+        json req = gerarRequisicao(r, gen);
+        auto res = cli.Post(ROTAS[r], req.dump(), "application/json");
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - agendado).count();
+
+        if (!res || res->status != 200) {
+            est.erros++;
+            continue;
+        }
+        est.latenciasUs[r].push_back(us);
+        if (cfg.verificar) {
+            try {
+                if (!respostaConfere(r, req, json::parse(res->body))) est.divergentes++;
+            } catch (const std::exception&) {
+                est.divergentes++;
+            }
+        }
+    }
+}
+
+static double percentil(const std::vector<double>& ordenado, double p) {
+    if (ordenado.empty()) return 0.0;
+    size_t i = (size_t)(p / 100.0 * (ordenado.size() - 1) + 0.5);
+    return ordenado[std::min(i, ordenado.size() - 1)];
+}
+
+static void imprimirLinha(const char* nome, std::vector<double> lat, double segundos) {
+    std::sort(lat.begin(), lat.end());
+    std::printf("%-12s %9zu %10.1f %9.0f %9.0f %9.0f %9.0f %9.0f\n", nome, lat.size(), lat.size() / segundos,
+                percentil(lat, 50), percentil(lat, 95), percentil(lat, 99), percentil(lat, 99.9),
+                lat.empty() ? 0.0 : lat.back());
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        auto arg = [&](const char* nome) { return std::strcmp(argv[i], nome) == 0 && i + 1 < argc; };
+        if (arg("--host")) cfg.host = argv[++i];
+        else if (arg("--port")) cfg.port = std::atoi(argv[++i]);
+        else if (arg("--duracao")) cfg.duracao = std::atof(argv[++i]);
+        else if (arg("--concorrencia")) cfg.concorrencia = std::max(1, std::atoi(argv[++i]));
+        else if (arg("--taxa")) cfg.taxa = std::atof(argv[++i]);
+        else if (arg("--mix")) std::sscanf(argv[++i], "%d,%d,%d", &cfg.pesos[0], &cfg.pesos[1], &cfg.pesos[2]);
+        else if (std::strcmp(argv[i], "--verificar") == 0) cfg.verificar = true;
+        else {
+            std::fprintf(stderr, "opção desconhecida: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::printf("alvo %s:%d, %d conexões, %.0fs, taxa %s, mix %d/%d/%d%s\n", cfg.host.c_str(), cfg.port,
+                cfg.concorrencia, cfg.duracao, cfg.taxa > 0 ? std::to_string((long)cfg.taxa).c_str() : "máxima",
+                cfg.pesos[0], cfg.pesos[1], cfg.pesos[2], cfg.verificar ? ", verificando respostas" : "");
+
+    std::vector<Estatisticas> stats(cfg.concorrencia);
+    std::vector<std::thread> threads;
+    std::atomic<long> proximoSlot{0};
+    auto inicio = Clock::now();
+    auto fim = inicio + std::chrono::microseconds((long)(cfg.duracao * 1e6));
+    for (int i = 0; i < cfg.concorrencia; i++)
+        threads.emplace_back(worker, std::cref(cfg), i, inicio, fim, std::ref(proximoSlot), std::ref(stats[i]));
+    for (auto& t : threads) t.join();
+    double segundos = std::chrono::duration<double>(Clock::now() - inicio).count();
+
+    std::vector<double> todas, porRota[3];
+    long erros = 0, divergentes = 0;
+    for (auto& e : stats) {
+        for (int r = 0; r < 3; r++) {
+            porRota[r].insert(porRota[r].end(), e.latenciasUs[r].begin(), e.latenciasUs[r].end());
+            todas.insert(todas.end(), e.latenciasUs[r].begin(), e.latenciasUs[r].end());
+        }
+        erros += e.erros;
+        divergentes += e.divergentes;
+    }
+
+    std::printf("\n%-12s %9s %10s %9s %9s %9s %9s %9s\n", "rota", "reqs", "req/s", "p50(us)", "p95(us)",
+                "p99(us)", "p99.9(us)", "max(us)");
+    for (int r = 0; r < 3; r++) imprimirLinha(ROTAS[r], porRota[r], segundos);
+    imprimirLinha("total", todas, segundos);
+    std::printf("\nerros: %ld", erros);
+    if (cfg.verificar) std::printf(", respostas divergentes: %ld", divergentes);
+    std::printf("\n");
+
+    return (erros > 0 || divergentes > 0) ? 1 : 0;
+}
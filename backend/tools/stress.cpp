@@ -0,0 +1,114 @@
+// Teste de estresse do recorte de linhas em várias threads.
+// Cada caso tem a sua própria janela; as threads recortam todos os casos em
+// ordens diferentes ao mesmo tempo e comparam cada resultado, bit a bit, com
+// o calculado antes numa thread só. Um estado compartilhado entre chamadas
+// (como a janela global que o Cohen-Sutherland tinha) mistura as janelas e
+// aparece como divergência.
+//
+// Uso: ./bin/stress [--threads N] [--casos N] [--rodadas N]
+//
+// Sai com código 1 se algum resultado divergir da referência.
+#include "../algorithms.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct Caso {
+    double x1, y1, x2, y2;
+    double rx, ry, rw, rh;
+};
+
+struct Resultado {
+    bool aceita;
+    double ox1, oy1, ox2, oy2;
+
+    bool operator==(const Resultado& o) const {
+        return aceita == o.aceita && (!aceita || (ox1 == o.ox1 && oy1 == o.oy1 && ox2 == o.ox2 && oy2 == o.oy2));
+    }
+};
+
+// Janelas e segmentos variados: coordenadas fracionárias, segmentos que
+// cruzam, ficam dentro, fora, degenerados em ponto e janelas achatadas
+static std::vector<Caso> gerarCasos(size_t n) {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> coord(-500.0, 500.0);
+    std::uniform_real_distribution<double> tamanho(0.0, 800.0);
+    std::vector<Caso> casos(n);
+    for (size_t i = 0; i < n; i++) {
+        Caso& c = casos[i];
+        c.x1 = coord(gen); c.y1 = coord(gen);
+        c.x2 = coord(gen); c.y2 = coord(gen);
+        c.rx = coord(gen); c.ry = coord(gen);
+        c.rw = tamanho(gen); c.rh = tamanho(gen);
+        if (i % 16 == 0) c.x2 = c.x1, c.y2 = c.y1;
+        if (i % 16 == 1) c.rh = 0.0;
+        if (i % 16 == 2) c.x1 = std::round(c.x1), c.y1 = std::round(c.y1), c.x2 = std::round(c.x2);
+    }
+    return casos;
+}
+
+static Resultado recortar(int algoritmo, const Caso& c) {
+    Resultado r;
+    r.aceita = algoritmo == 0
+        ? cohen_sutherland_clip(c.x1, c.y1, c.x2, c.y2, c.rx, c.ry, c.rw, c.rh, r.ox1, r.oy1, r.ox2, r.oy2)
+        : liang_barsky_clip(c.x1, c.y1, c.x2, c.y2, c.rx, c.ry, c.rw, c.rh, r.ox1, r.oy1, r.ox2, r.oy2);
+    return r;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::max(8u, 2 * std::thread::hardware_concurrency());
+    size_t nCasos = 20000;
+    int rodadas = 20;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--threads") == 0) threads = (unsigned)std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--casos") == 0) nCasos = (size_t)std::atol(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--rodadas") == 0) rodadas = std::atoi(argv[i + 1]);
+        else {
+            std::fprintf(stderr, "opção desconhecida: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    const std::vector<Caso> casos = gerarCasos(nCasos);
+    static const char* const NOMES[] = {"Cohen-Sutherland", "Liang-Barsky"};
+    bool ok = true;
+    for (int algoritmo = 0; algoritmo < 2; algoritmo++) {
+        std::vector<Resultado> referencia(casos.size());
+        size_t aceitas = 0;
+        for (size_t i = 0; i < casos.size(); i++) {
+            referencia[i] = recortar(algoritmo, casos[i]);
+            aceitas += referencia[i].aceita;
+        }
+
+        std::atomic<long> divergentes{0}, chamadas{0};
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back([&, t] {
+                // cada thread percorre os casos numa ordem própria
+                std::vector<size_t> ordem(casos.size());
+                for (size_t i = 0; i < ordem.size(); i++) ordem[i] = i;
+                std::mt19937 gen(100 + t);
+                long erros = 0;
+                for (int r = 0; r < rodadas; r++) {
+                    std::shuffle(ordem.begin(), ordem.end(), gen);
+                    for (size_t i : ordem)
+                        if (!(recortar(algoritmo, casos[i]) == referencia[i])) erros++;
+                }
+                divergentes += erros;
+                chamadas += (long)ordem.size() * rodadas;
+            });
+        }
+        for (auto& th : pool) th.join();
+
+        std::printf("%-17s %u threads, %ld recortes (%zu de %zu casos aceitos): %ld divergentes\n",
+                    NOMES[algoritmo], threads, chamadas.load(), aceitas, casos.size(), divergentes.load());
+        ok = ok && divergentes == 0;
+    }
+    return ok ? 0 : 1;
+}
@@ -1,4 +1,6 @@
 #include "transformations.h"
+#include <algorithm>
+#include <climits>
 #include <cmath>
 
 #ifndef M_PI
@@ -6,116 +8,141 @@
 #endif
 
 // Funções auxiliares
-static std::pair<int,int> centroLinha(const json& dados) {
-    int cx = (dados["x1"].get<int>() + dados["x2"].get<int>()) / 2;
-    int cy = (dados["y1"].get<int>() + dados["y2"].get<int>()) / 2;
-    return {cx, cy};
+static int arredondar(double v) {
+    if (!(v > INT_MIN)) return INT_MIN;   // também pega NaN
+    if (v >= INT_MAX) return INT_MAX;
+    return (int)std::lround(v);
 }
 
-static std::pair<int,int> centroCirculo(const json& dados) {
-    return {dados["xc"], dados["yc"]};
+static Affine translacao(double dx, double dy) {
+    Affine a;
+    a.m[0][2] = dx;
+    a.m[1][2] = dy;
+    return a;
 }
 
-// Linha
-json transformarLinha(const json& dados, const std::string& transf, const json& params) {
-    int x1 = dados["x1"].get<int>();
-    int y1 = dados["y1"].get<int>();
-    int x2 = dados["x2"].get<int>();
-    int y2 = dados["y2"].get<int>();
-    auto [cx, cy] = centroLinha(dados);
+// Transformação linear `l` em torno do pivô: T(c) * L * T(-c), que só
+// muda a coluna de translação para c - L*c
+static Affine emTornoDe(Affine l, double cx, double cy) {
+    l.m[0][2] = cx - (l.m[0][0] * cx + l.m[0][1] * cy);
+    l.m[1][2] = cy - (l.m[1][0] * cx + l.m[1][1] * cy);
+    return l;
+}
 
-    if (transf == "translacao") {
-        int dx = params["dx"].get<int>();
-        int dy = params["dy"].get<int>();
-        x1 += dx; y1 += dy;
-        x2 += dx; y2 += dy;
-    }
-    else if (transf == "escala") {
-        float sx = params["sx"].get<float>();
-        float sy = params["sy"].get<float>();
-        x1 = (int)((x1 - cx) * sx + cx);
-        y1 = (int)((y1 - cy) * sy + cy);
-        x2 = (int)((x2 - cx) * sx + cx);
-        y2 = (int)((y2 - cy) * sy + cy);
+Affine operator*(const Affine& a, const Affine& b) {
+    Affine r;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j];
+    return r;
+}
+
+Affine matrizDe(const TransformSpec& t, double cx, double cy) {
+    Affine l;
+    switch (t.tipo) {
+    case TransformType::Translacao:
+        return translacao(t.dx, t.dy);
+    case TransformType::Escala:
+        l.m[0][0] = t.sx;
+        l.m[1][1] = t.sy;
+        return emTornoDe(l, cx, cy);
+    case TransformType::Rotacao: {
+        double ang = t.angulo * M_PI / 180.0;
+        l.m[0][0] = std::cos(ang); l.m[0][1] = -std::sin(ang);
+        l.m[1][0] = std::sin(ang); l.m[1][1] = std::cos(ang);
+        return emTornoDe(l, cx, cy);
     }
-    else if (transf == "rotacao") {
-        float ang = params["angulo"].get<float>() * M_PI / 180.0f;
-        auto rot = [&](int x, int y) {
-            int dx = x - cx, dy = y - cy;
-            return std::pair<int,int>(
-                (int)(dx * cos(ang) - dy * sin(ang) + cx),
-                (int)(dx * sin(ang) + dy * cos(ang) + cy)
-            );
-        };
-        auto p1 = rot(x1,y1), p2 = rot(x2,y2);
-        x1=p1.first; y1=p1.second; x2=p2.first; y2=p2.second;
+    case TransformType::Cisalhamento:
+        l.m[0][1] = t.shx;
+        l.m[1][0] = t.shy;
+        return emTornoDe(l, cx, cy);
+    case TransformType::Reflexao:
+        if (t.eixo == 'x') l.m[1][1] = -1;          // reflexão no eixo X: (x, -y)
+        else if (t.eixo == 'y') l.m[0][0] = -1;     // reflexão no eixo Y: (-x, y)
+        else { l.m[0][0] = -1; l.m[1][1] = -1; }    // reflexão na origem
+        return l;
     }
-    else if (transf == "reflexao") {
-        std::string eixo = params["eixo"].get<std::string>();
-        auto ref = [&](int x, int y) {
+    return l;
+}
 
-            if (eixo=="x") return std::pair<int,int>(x, -y);       
-            if (eixo=="y") return std::pair<int,int>(-x, y);        
-            return std::pair<int,int>(-x, -y);                     
-        };
-        auto p1 = ref(x1,y1), p2 = ref(x2,y2);
-        x1=p1.first; y1=p1.second; x2=p2.first; y2=p2.second;
+void centroTransformado(const ShapeSpec& base, const Affine& m, double& cx, double& cy) {
+    if (base.tipo == ShapeType::Linha) {
+        const LineSpec& l = base.linha;
+        m.aplicar((l.x1 + l.x2) / 2.0, (l.y1 + l.y2) / 2.0, cx, cy);
+    } else if (base.tipo == ShapeType::Elipse) {
+        m.aplicar(base.elipse.xc, base.elipse.yc, cx, cy);
+    } else {
+        m.aplicar(base.circulo.xc, base.circulo.yc, cx, cy);
     }
+}
 
-    json novo = dados;
-    novo["x1"]=x1; novo["y1"]=y1; novo["x2"]=x2; novo["y2"]=y2;
-    return novo;
+Affine compor(const ShapeSpec& base, const Affine& m, const TransformSpec& t) {
+    double cx, cy;
+    centroTransformado(base, m, cx, cy);
+    return matrizDe(t, cx, cy) * m;
 }
 
+// Média dos valores singulares da parte linear: fator de escala do raio
+static double escalaMedia(const Affine& m) {
+    double a = m.m[0][0], b = m.m[0][1], c = m.m[1][0], d = m.m[1][1];
+    double q = a * a + b * b + c * c + d * d;
+    double det = a * d - b * c;
+    double disc = std::sqrt(std::max(0.0, q * q - 4 * det * det));
+    double s1 = std::sqrt((q + disc) / 2);
+    double s2 = std::sqrt(std::max(0.0, (q - disc) / 2));
+    return (s1 + s2) / 2;
+}
 
-// Círculo
-json transformarCirculo(const json& dados, const std::string& transf, const json& params) {
-    int xc = dados["xc"].get<int>();
-    int yc = dados["yc"].get<int>();
-    int r  = dados["r"].get<int>();
-    auto [cx, cy] = centroCirculo(dados);
-    (void)cx; // Suprime o aviso de variável não utilizada
-    (void)cy;
+// Semi-eixos da elipse alinhada que envolve a imagem da elipse (a, b) por
+// `m`: a metade da extensão em x e em y. Com escala e reflexão (e rotação
+// de 90°) é a imagem exata; rotação de um círculo mantém o raio.
+static void semiEixos(const Affine& m, double a, double b, double& rx, double& ry) {
+    rx = std::hypot(m.m[0][0] * a, m.m[0][1] * b);
+    ry = std::hypot(m.m[1][0] * a, m.m[1][1] * b);
+}
 
-    if (transf == "translacao") {
-        int dx = params["dx"].get<int>();
-        int dy = params["dy"].get<int>();
-        xc += dx; yc += dy;
-    }
-    else if (transf == "escala") {
-        float sx = params["sx"].get<float>();
-        float sy = params["sy"].get<float>();
-        float s = (sx+sy)/2.0f;
-        r = (int)(r * s);
-    }
-    else if (transf == "rotacao") {
-        // círculo não muda
-    }
-    else if (transf == "reflexao") {
-        std::string eixo = params["eixo"].get<std::string>();
-        // Para círculos no sistema cartesiano com reflexão em relação à origem (0,0):
-        // - Reflexão em X: mantém xc, inverte yc → (xc, -yc)
-        // - Reflexão em Y: inverte xc, mantém yc → (-xc, yc)
-        // - Reflexão em XY: inverte ambos → (-xc, -yc)
-        if (eixo=="x") yc = -yc;                    // reflexão no eixo X (horizontal)
-        else if (eixo=="y") xc = -xc;               // reflexão no eixo Y (vertical)  
-        else { xc = -xc; yc = -yc; }                // reflexão na origem
+ShapeSpec materializar(const ShapeSpec& base, const Affine& m) {
+    ShapeSpec s = base;
+    double x, y;
+    if (base.tipo == ShapeType::Linha) {
+        m.aplicar(base.linha.x1, base.linha.y1, x, y);
+        s.linha.x1 = arredondar(x); s.linha.y1 = arredondar(y);
+        m.aplicar(base.linha.x2, base.linha.y2, x, y);
+        s.linha.x2 = arredondar(x); s.linha.y2 = arredondar(y);
+        // a largura escala como o raio; linhas de 1 pixel continuam finas
+        if (base.linha.largura > 1)
+            s.linha.largura = std::max(1, arredondar(base.linha.largura * escalaMedia(m)));
+    } else if (base.tipo == ShapeType::Elipse) {
+        const EllipseSpec& e = base.elipse;
+        m.aplicar(e.xc, e.yc, x, y);
+        double rx, ry;
+        semiEixos(m, std::fabs((double)e.rx), std::fabs((double)e.ry), rx, ry);
+        s.elipse = {arredondar(x), arredondar(y), arredondar(rx), arredondar(ry), e.preenchida};
+    } else {
+        // escala não uniforme (ou cisalhamento) vira elipse, preenchida se
+        // era disco; com os dois semi-eixos iguais em pixels continua círculo
+        m.aplicar(base.circulo.xc, base.circulo.yc, x, y);
+        double r = std::fabs((double)base.circulo.r), rx, ry;
+        semiEixos(m, r, r, rx, ry);
+        if (arredondar(rx) == arredondar(ry)) {
+            s.circulo.xc = arredondar(x);
+            s.circulo.yc = arredondar(y);
+            s.circulo.r = base.circulo.r < 0 ? -arredondar(rx) : arredondar(rx);
+        } else {
+            s.tipo = ShapeType::Elipse;
+            s.elipse = {arredondar(x), arredondar(y), arredondar(rx), arredondar(ry),
+                        base.tipo == ShapeType::Disco};
+        }
     }
-
-    json novo = dados;
-    novo["xc"]=xc; novo["yc"]=yc; novo["r"]=r;
-    return novo;
+    return s;
 }
 
+ShapeSpec aplicarTransformacao(const ShapeSpec& obj, const TransformSpec& t) {
+    return materializar(obj, compor(obj, Affine(), t));
+}
 
-
-json aplicarTransformacao(
-    const json& dados,
-    const std::string& tipoObj,
-    const std::string& transf,
-    const json& params
-) {
-    if (tipoObj == "linha") return transformarLinha(dados, transf, params);
-    if (tipoObj == "circulo") return transformarCirculo(dados, transf, params);
-    return dados;
+ShapeSpec aplicarSequencia(const ShapeSpec& obj, const std::vector<TransformSpec>& ts) {
+    Affine m;
+    for (const auto& t : ts) m = compor(obj, m, t);
+    return materializar(obj, m);
 }
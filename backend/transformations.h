@@ -1,15 +1,40 @@
 #pragma once
-#include "libs/json.hpp"
-#include <string>
+#include <vector>
+#include "specs.h"
 
-using json = nlohmann::json;
+// Matriz afim 3x3 em coordenadas homogêneas (última linha sempre 0 0 1).
+// As transformações são compostas em double; o objeto só volta para
+// coordenadas inteiras ao ser materializado para rasterização.
+struct Affine {
+    double m[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
 
-json transformarLinha(const json& dados, const std::string& transf, const json& params);
-json transformarCirculo(const json& dados, const std::string& transf, const json& params);
+    void aplicar(double x, double y, double& ox, double& oy) const {
+        ox = m[0][0] * x + m[0][1] * y + m[0][2];
+        oy = m[1][0] * x + m[1][1] * y + m[1][2];
+    }
+};
 
-json aplicarTransformacao(
-    const json& dados,
-    const std::string& tipoObj,
-    const std::string& transf,
-    const json& params
-);
+// a * b: aplica b e depois a
+Affine operator*(const Affine& a, const Affine& b);
+
+// Matriz de uma transformação. Escala, rotação e cisalhamento usam o pivô
+// (cx, cy); translação e reflexão (pelos eixos/origem) não dependem dele.
+Affine matrizDe(const TransformSpec& t, double cx, double cy);
+
+// Centro do objeto `base` depois de `m` (meio da linha ou centro do círculo)
+void centroTransformado(const ShapeSpec& base, const Affine& m, double& cx, double& cy);
+
+// Compõe `t` depois de `m`, com pivô no centro atual do objeto
+Affine compor(const ShapeSpec& base, const Affine& m, const TransformSpec& t);
+
+// Aplica `m` a `base` e arredonda para pixels. Círculos e elipses viram a
+// elipse alinhada aos eixos com a mesma caixa envolvente da imagem (exata
+// para escala, reflexão e rotação de círculo); o círculo só continua
+// círculo se os dois semi-eixos arredondam igual. O disco segue a mesma
+// regra e vira elipse preenchida.
+ShapeSpec materializar(const ShapeSpec& base, const Affine& m);
+
+ShapeSpec aplicarTransformacao(const ShapeSpec& obj, const TransformSpec& t);
+
+// Sequência inteira composta numa matriz e materializada uma única vez
+ShapeSpec aplicarSequencia(const ShapeSpec& obj, const std::vector<TransformSpec>& ts);
@@ -161,6 +161,30 @@ let selecionados = [];
 // === Desenho ===
 
 function drawObjeto(obj) {
+  // Spans (resposta com "saida": "spans"): um fillRect por scanline
+  if (obj.spans && Array.isArray(obj.spans) && obj.spans.length > 0) {
+    const isDark = document.documentElement.getAttribute('data-theme') === 'dark';
+    ctx.fillStyle = obj.selecionado ? 'red' : (isDark ? '#f1f5f9' : 'black');
+    for (const [y, x0, x1] of obj.spans) {
+      const canvasPos = cartesianToCanvas(x0, y);
+      ctx.fillRect(Math.round(canvasPos.x), Math.round(canvasPos.y), x1 - x0 + 1, 1);
+    }
+    return;
+  }
+
+  // Cobertura (linha wu): [x, y, a] com a em 0..255 vira a opacidade do pixel
+  if (obj.cobertura && Array.isArray(obj.cobertura) && obj.cobertura.length > 0) {
+    const isDark = document.documentElement.getAttribute('data-theme') === 'dark';
+    ctx.fillStyle = obj.selecionado ? 'red' : (isDark ? '#f1f5f9' : 'black');
+    for (const [x, y, a] of obj.cobertura) {
+      const canvasPos = cartesianToCanvas(x, y);
+      ctx.globalAlpha = a / 255;
+      ctx.fillRect(Math.round(canvasPos.x), Math.round(canvasPos.y), 1, 1);
+    }
+    ctx.globalAlpha = 1;
+    return;
+  }
+
   // Prioridade: se houver pixels (preview ou raster), desenhe-os
   if (obj.pixels && Array.isArray(obj.pixels) && obj.pixels.length > 0) {
     const isDark = document.documentElement.getAttribute('data-theme') === 'dark';
@@ -273,6 +297,9 @@ function limparCanvas() {
   selectEnd = null;
   ctx.clearRect(0, 0, canvas.width, canvas.height);
   drawCartesianAxes();
+  // a cena no servidor acompanha o canvas
+  fetch("http://localhost:8080/scene", { method: "DELETE" })
+    .catch(err => console.error("limparCanvas error:", err));
 }
 
 function getModo() {
@@ -308,11 +335,21 @@ canvas.addEventListener("click", async (e) => {
     const r = Math.floor(Math.sqrt(dx * dx + dy * dy));
     await sendDraw({ algoritmo, xc: clicks[0].x, yc: clicks[0].y, r }, "circulo");
     clicks = [];
+  } else if (algoritmo === "disco" && clicks.length === 2) {
+    // disco preenchido: o servidor devolve um span por scanline
+    const dx = clicks[1].x - clicks[0].x;
+    const dy = clicks[1].y - clicks[0].y;
+    const r = Math.floor(Math.sqrt(dx * dx + dy * dy));
+    await sendDraw({ tipo: "disco", xc: clicks[0].x, yc: clicks[0].y, r, saida: "spans" }, "disco");
+    clicks = [];
   } else if (clicks.length === 2) {
-    await sendDraw(
-      { algoritmo, x1: clicks[0].x, y1: clicks[0].y, x2: clicks[1].x, y2: clicks[1].y },
-      "linha"
-    );
+    // linha grossa (largura > 1) é preenchida no servidor, com a ponta escolhida,
+    // e volta em spans como o disco
+    const largura = Math.max(1, parseInt(document.getElementById("largura").value) || 1);
+    const ponta = document.getElementById("ponta").value;
+    const payload = { algoritmo, x1: clicks[0].x, y1: clicks[0].y, x2: clicks[1].x, y2: clicks[1].y, largura, ponta };
+    if (largura > 1) payload.saida = "spans";
+    await sendDraw(payload, "linha");
     clicks = [];
   }
 });
@@ -321,7 +358,8 @@ async function sendDraw(payload, tipo) {
   try {
     updateStatus('Desenhando...', 'warning');
     
-    const res = await fetch("http://localhost:8080/draw", {
+    // o objeto fica guardado na cena do servidor; transformações usam o id
+    const res = await fetch("http://localhost:8080/scene/objects", {
       method: "POST",
       headers: { "Content-Type": "application/json" },
       body: JSON.stringify(payload),
@@ -336,9 +374,12 @@ async function sendDraw(payload, tipo) {
     console.log("sendDraw response:", data);
 
     addObjeto({
+      id: data.id,
       tipo,
-      dados: payload,
+      dados: data.dados,
       pixels: data.pixels || [],
+      spans: data.spans,
+      cobertura: data.cobertura,
       selecionado: false,
     });
     
@@ -404,24 +445,40 @@ function drawSelectionBox() {
   );
 }
 
-function selecionarObjetos() {
+// IDs dos objetos da cena que passam pelo retângulo (índice espacial no servidor)
+async function buscarIdsNaArea(xmin, ymin, xmax, ymax) {
+  const res = await fetch("http://localhost:8080/select", {
+    method: "POST",
+    headers: { "Content-Type": "application/json" },
+    body: JSON.stringify({ xmin, ymin, xmax, ymax })
+  });
+  if (!res.ok) {
+    const text = await res.text().catch(() => "");
+    throw new Error(`Servidor retornou status ${res.status}. Body: ${text}`);
+  }
+  const data = await res.json();
+  return new Set(data.ids);
+}
+
+async function selecionarObjetos() {
   if (!selectStart || !selectEnd) return;
   const x1 = Math.min(selectStart.x, selectEnd.x);
   const y1 = Math.min(selectStart.y, selectEnd.y);
   const x2 = Math.max(selectStart.x, selectEnd.x);
   const y2 = Math.max(selectStart.y, selectEnd.y);
 
-  selecionados = [];
-  objetos.forEach((obj) => {
-    const dentro = obj.pixels.some(p => {
-      const px = p.x ?? p[0];
-      const py = p.y ?? p[1];
-      return px >= x1 && px <= x2 && py >= y1 && py <= y2;
+  try {
+    const ids = await buscarIdsNaArea(x1, y1, x2, y2);
+    selecionados = [];
+    objetos.forEach((obj) => {
+      obj.selecionado = ids.has(obj.id);
+      if (obj.selecionado) selecionados.push(obj);
     });
-    obj.selecionado = dentro;
-    if (dentro) selecionados.push(obj);
-  });
-  atualizarCanvas();
+    atualizarCanvas();
+  } catch (err) {
+    console.error("selecionarObjetos error:", err);
+    updateStatus('Erro na seleção', 'error');
+  }
 }
 
 // === Recorte ===
@@ -439,60 +496,62 @@ async function aplicarRecorte() {
   // pega o algoritmo selecionado
   const algoritmoRecorte = document.getElementById("recorteAlgoritimo").value;
 
-  // pega os objetos que têm pixels dentro do retângulo
-  const recortados = objetos.filter(obj =>
-    obj.pixels && obj.pixels.some(p => {
-      const px = p.x ?? p[0];
-      const py = p.y ?? p[1];
-      return px >= xmin && px <= xmax && py >= ymin && py <= ymax;
-    })
-  );
+  // pega os objetos que passam pelo retângulo
+  let ids;
+  try {
+    ids = await buscarIdsNaArea(xmin, ymin, xmax, ymax);
+  } catch (err) {
+    console.error("aplicarRecorte error:", err);
+    return alert("Erro ao comunicar com o servidor: " + err.message + ". Verifique console/server.");
+  }
+  const recortados = objetos.filter(obj => ids.has(obj.id));
 
   // se nenhum objeto for recortado, avisa e sai
   if (recortados.length === 0) {
     return alert("Nenhum objeto encontrado na área selecionada.");
   }
 
-  // se for encontrado circulo, avisa que não é suportado
-  if (recortados.some(o => o.tipo === 'circulo')) {
-    return alert("Recorte de círculos não é suportado.");
+  // se for encontrado circulo ou elipse, avisa que não é suportado
+  if (recortados.some(o => o.tipo === 'circulo' || o.tipo === 'elipse')) {
+    return alert("Recorte de círculos e elipses não é suportado.");
   }
 
   // faz snapshot para possível undo (opcional)
   originalObjetosSnapshot = JSON.parse(JSON.stringify(objetos));
 
-  // envia requisições individuais para o backend, conforme esperado pelo backend C++
+  // recorta todos os objetos numa única requisição (pelos ids da cena)
   try {
-    const resultados = [];
-    for (const obj of recortados) {
-      const reqBody = {
-        tipo: obj.tipo,
-        dados: obj.dados,
+    const res = await fetch("http://localhost:8080/clip/scene", {
+      method: "POST",
+      headers: { "Content-Type": "application/json" },
+      body: JSON.stringify({
+        ids: recortados.map(obj => obj.id),
         algoritmo: algoritmoRecorte,
         xmin,
         ymin,
         xmax,
         ymax
-      };
-      const res = await fetch("http://localhost:8080/clip", {
-        method: "POST",
-        headers: { "Content-Type": "application/json" },
-        body: JSON.stringify(reqBody)
-      });
-      if (!res.ok) {
-        const text = await res.text().catch(() => "");
-        throw new Error(`Servidor retornou status ${res.status}. Body: ${text}`);
-      }
-      const data = await res.json();
-      if (data.aceita && data.pixels && data.pixels.length > 0) {
+      })
+    });
+    if (!res.ok) {
+      const text = await res.text().catch(() => "");
+      throw new Error(`Servidor retornou status ${res.status}. Body: ${text}`);
+    }
+    const data = await res.json();
+    const resultados = [];
+    data.resultados.forEach((r) => {
+      // a linha wu vem com cobertura; no preview só as posições importam
+      const pixels = r.pixels || (r.cobertura || []).map(([x, y]) => ({ x, y }));
+      if (r.aceita && pixels.length > 0) {
         resultados.push({
-          tipo: obj.tipo,
-          dados: obj.dados,
-          pixels: data.pixels,
+          id: r.id,
+          tipo: r.tipo,
+          dados: r.dados,
+          pixels,
           selecionado: false
         });
       }
-    }
+    });
 
     if (resultados.length === 0) {
       alert("Nenhum objeto foi recortado (nenhum pixel dentro da área).");
@@ -554,16 +613,14 @@ async function aplicarTransformacao(transf) {
   const params = coletarParametrosTransformacao(transf);
 
   try {
-    for (let obj of selecionados) {
-      const res = await fetch("http://localhost:8080/transform", {
-        method: "POST",
-        headers: { "Content-Type": "application/json" },
-        body: JSON.stringify({tipo: obj.tipo, dados: obj.dados, transf, params})
-      });
-      const data = await res.json();
-      obj.dados = data.dados;
-      obj.pixels = data.pixels;
-    }
+    // discos (e as elipses preenchidas que eles viram) e linhas grossas voltam
+    // em spans, como no sendDraw; o resto em pixels (a linha wu precisa da cobertura)
+    const cheio = obj => obj.tipo === "disco" ||
+      (obj.dados && (obj.dados.preenchida === true || obj.dados.largura > 1));
+    const discos = selecionados.filter(cheio);
+    const outros = selecionados.filter(obj => !cheio(obj));
+    if (discos.length > 0) await transformarNaCena(discos, transf, params, "spans");
+    if (outros.length > 0) await transformarNaCena(outros, transf, params, "pixels");
 
     updateStatus(`${transf} aplicada com sucesso`, 'success');
     atualizarCanvas();
@@ -574,6 +631,25 @@ async function aplicarTransformacao(transf) {
   }
 }
 
+// Só os ids vão ao servidor; a geometria está na cena
+async function transformarNaCena(objs, transf, params, saida) {
+  const res = await fetch("http://localhost:8080/scene/transform", {
+    method: "POST",
+    headers: { "Content-Type": "application/json" },
+    body: JSON.stringify({ ids: objs.map(obj => obj.id), transf, params, saida })
+  });
+  const data = await res.json();
+  data.resultados.forEach((r, i) => {
+    if (r.error) return;
+    // escala não uniforme transforma círculo em elipse (e disco em elipse preenchida)
+    if (r.tipo) objs[i].tipo = r.tipo;
+    objs[i].dados = r.dados;
+    objs[i].pixels = r.pixels;
+    objs[i].spans = r.spans;
+    objs[i].cobertura = r.cobertura;
+  });
+}
+
 // Função para feedback visual dos botões
 function addButtonFeedback(button) {
   button.style.transform = 'scale(0.95)';